@@ -0,0 +1,89 @@
+/*
+  ==============================================================================
+    AnalysisWorker.cpp
+
+    Authors:    agent
+
+    SPDX-License-Identifier: BSD-3-Clause
+ ==============================================================================
+*/
+
+#include "AnalysisWorker.h"
+
+AnalysisWorker::AnalysisWorker(FilterModelStore& modelStore)
+:Thread("FDM analysis"),m_modelStore(modelStore),m_updatePending(false)
+{
+}
+
+AnalysisWorker::~AnalysisWorker()
+{
+    cancelPendingUpdate();
+    stopThread(2000);
+}
+
+void AnalysisWorker::requestUpdate()
+{
+    m_updatePending = true;
+    notify();
+}
+
+void AnalysisWorker::run()
+{
+    while (!threadShouldExit())
+    {
+        if (!m_updatePending.exchange(false))
+        {
+            if (!needsRefinement())
+            {
+                wait(-1);
+                continue;
+            }
+            // a request during the idle time restarts the quick path
+            if (wait(REFINE_IDLE_TIME_MS) || m_updatePending)
+                continue;
+
+            refineTasks();
+            triggerAsyncUpdate();
+            continue;
+        }
+        // always the newest model, all requests since the last run are merged
+        auto model = m_modelStore.getModel();
+        for (auto task : m_tasks)
+        {
+            if (threadShouldExit())
+                return;
+
+            task->compute(*model);
+        }
+        triggerAsyncUpdate();
+    }
+}
+
+bool AnalysisWorker::needsRefinement() const
+{
+    for (auto task : m_tasks)
+        if (task->needsRefinement())
+            return true;
+
+    return false;
+}
+
+void AnalysisWorker::refineTasks()
+{
+    auto model = m_modelStore.getModel();
+    auto shouldCancel = [this]() { return m_updatePending.load() || threadShouldExit(); };
+    for (auto task : m_tasks)
+    {
+        if (shouldCancel())
+            return;
+
+        if (task->needsRefinement())
+            task->refine(*model, shouldCancel);
+    }
+}
+
+void AnalysisWorker::handleAsyncUpdate()
+{
+    for (auto task : m_tasks)
+        task->publish();
+}
@@ -0,0 +1,75 @@
+/*
+  ==============================================================================
+    AnalysisWorker.h
+
+    Background thread for the GUI computations (frequency response, 3D
+    surface, ...). Components register as tasks. A change request only sets a
+    flag, so requests that arrive while the worker is busy are merged into
+    one new run with the latest filter model (stale intermediate states are
+    dropped). Finished results are handed back on the message thread via
+    publish(), which should only swap buffers and repaint.
+
+    A task can answer a change with a quick low quality result and ask for
+    a refinement. The refinement runs after REFINE_IDLE_TIME_MS without new
+    changes and is cancelled as soon as the next change comes in.
+
+    Authors:    agent
+
+    SPDX-License-Identifier: BSD-3-Clause
+ ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <vector>
+#include <JuceHeader.h>
+#include "FilterModel.h"
+
+#define REFINE_IDLE_TIME_MS 150
+
+class AnalysisWorker : public Thread, private AsyncUpdater
+{
+public:
+    class Task
+    {
+    public:
+        virtual ~Task() = default;
+        // worker thread: compute the results for this model (may return early if nothing to do)
+        virtual void compute(const FilterModel& model) = 0;
+        // message thread: take over the finished results
+        virtual void publish() = 0;
+
+        // worker thread: true if the last compute() result should be refined
+        virtual bool needsRefinement() const { return false; };
+        // worker thread: compute the full quality result, stop early if shouldCancel() is true
+        virtual void refine(const FilterModel& model, const std::function<bool()>& shouldCancel)
+        {
+            ignoreUnused(model, shouldCancel);
+        };
+    };
+
+    AnalysisWorker(FilterModelStore& modelStore);
+    ~AnalysisWorker();
+
+    // add all tasks before start()
+    void addTask(Task* task) { m_tasks.push_back(task); };
+    void start() { startThread(3); };
+
+    // can be called from any thread, as often as needed
+    void requestUpdate();
+
+    void run() override;
+
+private:
+    void handleAsyncUpdate() override;
+    bool needsRefinement() const;
+    void refineTasks();
+
+    FilterModelStore& m_modelStore;
+    std::vector<Task*> m_tasks;
+    std::atomic<bool> m_updatePending;
+
+    JUCE_DECLARE_NON_COPYABLE (AnalysisWorker)
+};
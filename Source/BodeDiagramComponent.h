@@ -20,12 +20,15 @@
 #include "BodeMagnitudeComponent.h"
 #include "BodePhaseComponent.h"
 #include "PNParameter.h"
+#include "FrequencyResponseEngine.h"
+#include "FilterModel.h"
+#include "AnalysisWorker.h"
 
 const float localPi = 3.14159265358979323846;
 //==============================================================================
 /*
 */
-class BodeDiagramComponent    : public Component
+class BodeDiagramComponent    : public Component, public AnalysisWorker::Task
 {
 public:
     enum LayoutTypes
@@ -35,15 +38,32 @@ public:
         none
     };
 
-    BodeDiagramComponent(AudioProcessorValueTreeState& vts, LayoutTypes layout)
-        : m_vts(vts), m_layout(layout), m_bodeMagnitudePlot(true),
-        m_bodePhasePlot(false), m_numberOfSamples(1000), m_fs(48000.0f), m_plot_0_to_fs(false)
+    BodeDiagramComponent(AudioProcessorValueTreeState& vts, FilterModelStore& modelStore, LayoutTypes layout)
+        : m_vts(vts), m_modelStore(modelStore), m_modelVersion(0), m_layout(layout), m_bodeMagnitudePlot(true),
+        m_bodePhasePlot(false), m_fs(48000.0f), m_plot_0_to_fs(false),
+        m_visibleMinFreq(0.0f), m_visibleMaxFreq(24000.0f), m_hasNewData(false)
     {
         // In your constructor, you should add any child components, and
         // initialise any special settings that your component needs.
         addAndMakeVisible(m_bodeMagnitudePlot);
         addAndMakeVisible(m_bodePhasePlot);
-        updatePlot();
+
+        // both plots show the same frequency range and scale
+        m_bodeMagnitudePlot.xAxisChanged = [this]() { frequencyAxisChanged(m_bodeMagnitudePlot, m_bodePhasePlot); };
+        m_bodePhasePlot.xAxisChanged = [this]() { frequencyAxisChanged(m_bodePhasePlot, m_bodeMagnitudePlot); };
+        m_bodePhasePlot.modeChanged = [this]()
+        {
+            m_bodePhasePlot.setData(m_plotFrequency, m_plotPhase[m_bodePhasePlot.getMode()]);
+        };
+        m_bodeMagnitudePlot.analyserToggled = [this](bool active)
+        {
+            if (analyserToggled != nullptr)
+                analyserToggled(active);
+        };
+
+        // first data synchronous, all updates come from the analysis worker
+        compute(*m_modelStore.getModel());
+        publish();
     }
 
     ~BodeDiagramComponent()
@@ -87,112 +107,128 @@ public:
 
         m_bodePhasePlot.setSamplingRate(fs); 
         m_bodeMagnitudePlot.setSamplingRate(fs);
+        m_visibleMinFreq = 0.f;
+        m_visibleMaxFreq = fs;
+
+        // the frequency axis changed, the next compute is done even for the same model
+        m_modelVersion = 0;
     }
 
-    void updatePlot()
+    // asks for a new compute (see AnalysisWorker::requestUpdate)
+    std::function<void()> needsUpdate;
+
+    // analyser overlay of the magnitude plot (switched on and off by its analyser button)
+    std::function<void(bool)> analyserToggled;
+    void setSpectrum(const SpectrumAnalyser::Spectrum& spectrum)
     {
-        std::vector<float> frequencyVec;
-        std::vector<float> magnitudeVec;
-        std::vector<float> phaseVec;
+        m_bodeMagnitudePlot.setSpectrum(spectrum);
+    }
 
-        updateDataFromPoleZero(frequencyVec, magnitudeVec, phaseVec);
+    // analysis worker thread
+    void compute(const FilterModel& model) override
+    {
+        if (model.version == m_modelVersion)
+            return;
+
+        m_modelVersion = model.version;
+        updateDataFromModel(model);
+
+        // no allocation once the vectors had their largest size (ADAPTIVE_MAX_POINTS)
+        const ScopedLock lock(m_resultLock);
+        m_readyFrequency = m_frequencyVec;
+        m_readyMagnitude = m_engine.getMagnitude_dB();
+        for (auto mode = 0; mode < BodePhaseComponent::nrofmodes; ++mode)
+            m_readyPhase[mode] = m_engine.getResult(getPhaseResult(mode));
+        m_hasNewData = true;
+    }
 
-        m_bodePhasePlot.setData(frequencyVec, phaseVec);
-        m_bodeMagnitudePlot.setData(frequencyVec, magnitudeVec);
+    // message thread
+    void publish() override
+    {
+        {
+            const ScopedLock lock(m_resultLock);
+            if (!m_hasNewData)
+                return;
+
+            m_hasNewData = false;
+            m_plotFrequency.swap(m_readyFrequency);
+            m_plotMagnitude.swap(m_readyMagnitude);
+            for (auto mode = 0; mode < BodePhaseComponent::nrofmodes; ++mode)
+                m_plotPhase[mode].swap(m_readyPhase[mode]);
+        }
+        m_bodePhasePlot.setData(m_plotFrequency, m_plotPhase[m_bodePhasePlot.getMode()]);
+        m_bodeMagnitudePlot.setData(m_plotFrequency, m_plotMagnitude);
         repaint();
     }
 
 private:
   
     AudioProcessorValueTreeState& m_vts;
+    FilterModelStore& m_modelStore;
+    std::atomic<uint32> m_modelVersion;
 
-    PNParameter m_PNparam;
-    int m_numOfPole = m_PNparam.maxNrOfPole;
-    int m_numOfZero = m_PNparam.maxNrOfZero;
-
-    int m_numberOfSamples;
-    float m_fs;
+    std::atomic<float> m_fs;
 
     // set true to plot from 0 to fs, else 0 to fs/2 will be plotted
     bool m_plot_0_to_fs; 
 
-    std::vector<std::complex<float>> m_poles;
-    std::vector<std::complex<float>> m_zeros;
+    // only the visible (zoomed) range is computed
+    std::atomic<float> m_visibleMinFreq;
+    std::atomic<float> m_visibleMaxFreq;
+
+    // used by the worker only
+    FrequencyResponseEngine m_engine;
+    std::vector<float> m_frequencyVec;
+
+    // finished results, handed over to the message thread
+    CriticalSection m_resultLock;
+    bool m_hasNewData;
+    std::vector<float> m_readyFrequency, m_readyMagnitude;
+    std::vector<float> m_plotFrequency, m_plotMagnitude;
+    // all modes of the phase plot are computed in the same pass, a mode change needs no new compute
+    std::vector<float> m_readyPhase[BodePhaseComponent::nrofmodes];
+    std::vector<float> m_plotPhase[BodePhaseComponent::nrofmodes];
 
     LayoutTypes m_layout;
 
     BodePhaseComponent m_bodePhasePlot;
     BodeMagnitudeComponent m_bodeMagnitudePlot;
 
-    void updateDataFromPoleZero(std::vector<float>& frequency,
-        std::vector<float>& magnitude, std::vector<float>& phase)
+    void updateDataFromModel(const FilterModel& model)
     {
-        updatePoleAndZero();
-        
-        float freqStep = 0;
-        float angleStep = 0;
-        if (m_plot_0_to_fs)
-        {
-            freqStep = m_fs / m_numberOfSamples;
-            angleStep = 2 * localPi / m_numberOfSamples;
-        } else {
-            freqStep = m_fs/2 / m_numberOfSamples;
-            angleStep = localPi / m_numberOfSamples;
-        }
-        
-
-        for (auto kk = 0; kk <= m_numberOfSamples; ++kk)
-        {
-            float realPart = cos(kk * angleStep);
-            float imagPart = sin(kk * angleStep);
-            std::complex<float> z(realPart, imagPart);
-            //std::complex<float> z;
-            //z = exp(kk * angleStep);
-            std::complex<float> h;
-            float b0 = *(m_vts.getRawParameterValue(paramb0.ID));
-            h = pow(10, (b0/20));       // from dB to linear
-            for (auto ll = 0U; ll < m_zeros.size(); ++ll)
-                h *= (z - m_zeros[ll]);
-            for (auto ll = 0U; ll < m_poles.size(); ++ll)
-                h /= (z - m_poles[ll]);
-
-            frequency.push_back(kk * freqStep);
-            magnitude.push_back(20 * log10(std::abs(h)));
-            //magnitude.push_back(std::abs(h));
-            phase.push_back(std::arg(h) * 180 / localPi);
-        }
+        // log-spaced and refined near fast changes, the visible range only
+        float fs = m_fs.load();
+        m_engine.computeAdaptive(model.poles, model.zeros, model.gain_dB,
+            m_visibleMinFreq.load() / fs, m_visibleMaxFreq.load() / fs);
+
+        const auto& normFreq = m_engine.getNormFrequency();
+        m_frequencyVec.resize(normFreq.size());
+        FloatVectorOperations::multiply(m_frequencyVec.data(), normFreq.data(), fs,
+            static_cast<int>(normFreq.size()));
     }
 
-    void updatePoleAndZero()
+    static FrequencyResponseEngine::Results getPhaseResult(int mode)
     {
-        m_poles.clear();
-        m_zeros.clear();
-
-        for (auto kk = 0; kk < m_numOfPole; ++kk)
-        {
-            if (m_vts.getParameter(paramPoleBool.ID[kk])->getValue())
-            {
-                float real = *(m_vts.getRawParameterValue(paramPoleReal.ID[kk]));
-                float imag = *(m_vts.getRawParameterValue(paramPoleImag.ID[kk]));
-                m_poles.push_back(std::complex<float>(real, imag));
-
-                if (m_vts.getParameter(paramPoleConjugated.ID[kk])->getValue())
-                    m_poles.push_back(std::complex<float>(real, -imag));
-            }
-        }
-        for (auto kk = 0; kk < m_numOfZero; ++kk)
+        switch (mode)
         {
-            if (m_vts.getParameter(paramZeroBool.ID[kk])->getValue())
-            {
-                float real = *(m_vts.getRawParameterValue(paramZeroReal.ID[kk]));
-                float imag = *(m_vts.getRawParameterValue(paramZeroImag.ID[kk]));
-                m_zeros.push_back(std::complex<float>(real, imag));
-
-                if (m_vts.getParameter(paramZeroConjugated.ID[kk])->getValue())
-                    m_zeros.push_back(std::complex<float>(real, -imag));
-            }
+        case BodePhaseComponent::unwrapped: return FrequencyResponseEngine::unwrappedPhase_deg;
+        case BodePhaseComponent::groupDelay: return FrequencyResponseEngine::groupDelay;
+        case BodePhaseComponent::phaseDelay: return FrequencyResponseEngine::phaseDelay;
+        default: return FrequencyResponseEngine::phase_deg;
         }
+    }
 
+    // message thread, after a zoom, pan or lin/log change in one of the plots
+    void frequencyAxisChanged(ScaledPlot& source, ScaledPlot& other)
+    {
+        other.setLogScale(source.isLogScaleActivated());
+        other.setVisibleRangeX(source.getVisibleMinX(), source.getVisibleMaxX());
+        m_visibleMinFreq = static_cast<float>(source.getVisibleMinX());
+        m_visibleMaxFreq = static_cast<float>(source.getVisibleMaxX());
+
+        m_modelVersion = 0;
+        if (needsUpdate != nullptr)
+            needsUpdate();
     }
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BodeDiagramComponent)
@@ -15,15 +15,14 @@
 
 //==============================================================================
 BodeMagnitudeComponent::BodeMagnitudeComponent(bool withAutoScale)
-    : ScaledPlot(withAutoScale)
+    : ScaledPlot(withAutoScale), m_analyserMode(analyserOff)
 {
     // In your constructor, you should add any child components, and
     // initialise any special settings that your component needs.
     m_axisLabelLogX = String("Frequency / Hz");
     m_axisLabelX    = String("Frequency / kHz");
-    m_minValueX     = 0.0f;
-    m_maxValueX     = 10000.0f;
-    m_valueStepX    = 1000.0f;
+    setFullRangeX(0.0, 10000.0);
+    m_withZoom = true;
 
     m_axisLabelY    = String("Magnitude / dB");
     m_minValueY     = -60.0f;
@@ -31,6 +30,18 @@ BodeMagnitudeComponent::BodeMagnitudeComponent(bool withAutoScale)
     m_valueStepY    = 20.0f;
     
     addAndMakeVisible(m_logButton);
+
+    m_analyserButton.setColour(TextButton::ColourIds::buttonColourId, Colours::darkgreen);
+    m_analyserButton.onClick = [this]()
+    {
+        bool wasActive = m_analyserMode != analyserOff;
+        setAnalyserMode(static_cast<AnalyserModes>((m_analyserMode + 1) % nrofanalysermodes));
+        bool isActive = m_analyserMode != analyserOff;
+        if (wasActive != isActive && analyserToggled != nullptr)
+            analyserToggled(isActive);
+    };
+    setAnalyserMode(analyserOff);
+    addAndMakeVisible(m_analyserButton);
 }
 
 BodeMagnitudeComponent::~BodeMagnitudeComponent()
@@ -52,7 +63,157 @@ void BodeMagnitudeComponent::paint (Graphics& g)
 void BodeMagnitudeComponent::resized()
 {
     ScaledPlot::resized();
+    // next to the lin/log button
+    m_analyserButton.setBounds(getLocalBounds().removeFromBottom(BUTTON_HEIGHT).withTrimmedLeft(BUTTON_WIDTH)
+        .removeFromLeft(BUTTON_WIDTH).reduced(BUTTON_PADDING));
     // This method is where you should set the bounds of any child
     // components that your component contains..
 
 }
+
+void BodeMagnitudeComponent::setAnalyserMode(AnalyserModes mode)
+{
+    m_analyserMode = mode;
+    switch (mode)
+    {
+    case AnalyserModes::analyserSpectrum:
+        m_analyserButton.setButtonText("fft");
+        break;
+    case AnalyserModes::analyserTransfer:
+        m_analyserButton.setButtonText("H1");
+        break;
+    default:
+        m_analyserButton.setButtonText("off");
+        clearSpectrum();
+        break;
+    }
+    repaint();
+}
+
+void BodeMagnitudeComponent::setSpectrum(const SpectrumAnalyser::Spectrum& spectrum)
+{
+    if (m_analyserMode == analyserOff)
+        return;
+
+    m_spectrum.frequency = spectrum.frequency;
+    m_spectrum.input_dB = spectrum.input_dB;
+    m_spectrum.output_dB = spectrum.output_dB;
+    m_spectrum.transfer_dB = spectrum.transfer_dB;
+    m_spectrum.coherence = spectrum.coherence;
+    repaint();
+}
+
+void BodeMagnitudeComponent::clearSpectrum()
+{
+    m_spectrum.frequency.clear();
+    repaint();
+}
+
+void BodeMagnitudeComponent::paintOverlay(Graphics& g)
+{
+    if (m_spectrum.frequency.empty())
+        return;
+
+    if (m_analyserMode == analyserSpectrum)
+    {
+        overlayToPath(m_spectrum.input_dB, levelScale, true);
+        g.setColour(SpectrumInputColour);
+        g.fillPath(m_spectrumPath);
+
+        overlayToPath(m_spectrum.output_dB, levelScale, false);
+        g.setColour(SpectrumOutputColour);
+        g.strokePath(m_spectrumPath, PathStrokeType(1.0f));
+    }
+    if (m_analyserMode == analyserTransfer)
+    {
+        overlayToPath(m_spectrum.coherence, coherenceScale, true);
+        g.setColour(SpectrumCoherenceColour);
+        g.fillPath(m_spectrumPath);
+
+        // on the magnitude axis, directly comparable to the model
+        overlayToPath(m_spectrum.transfer_dB, magnitudeScale, false, &m_spectrum.coherence);
+        g.setColour(SpectrumTransferColour);
+        g.strokePath(m_spectrumPath, PathStrokeType(1.5f));
+    }
+}
+
+void BodeMagnitudeComponent::overlayToPath(const std::vector<float>& values, OverlayScales scale, bool closed,
+    const std::vector<float>* coherence)
+{
+    m_spectrumPath.clear();
+
+    int column = -1;
+    int firstColumn = 0;
+    int minY = 0;
+    bool newSubPath = true;
+    auto addPoint = [&]()
+    {
+        if (!newSubPath)
+            m_spectrumPath.lineTo(column, minY);
+        else if (closed)
+        {
+            firstColumn = column;
+            m_spectrumPath.startNewSubPath(column, m_endPosY);
+            m_spectrumPath.lineTo(column, minY);
+        }
+        else
+            m_spectrumPath.startNewSubPath(column, minY);
+        newSubPath = false;
+    };
+
+    for (auto kk = 0U; kk < m_spectrum.frequency.size() && kk < values.size(); ++kk)
+    {
+        double xValue = toAxisValueX(m_spectrum.frequency[kk]);
+        if (xValue < m_minValueX || xValue > m_maxValueX)
+            continue;
+
+        if (coherence != nullptr && (*coherence)[kk] < SPECTRUM_MIN_COHERENCE)
+        {
+            // gap in the curve
+            if (column >= 0)
+                addPoint();
+            column = -1;
+            newSubPath = true;
+            continue;
+        }
+
+        int xPos = scaleToCoordsX(xValue);
+        int yPos = overlayToCoordsY(values[kk], scale);
+        if (xPos != column)
+        {
+            if (column >= 0)
+                addPoint();
+            column = xPos;
+            minY = yPos;
+        }
+        else
+            minY = jmin(minY, yPos);
+    }
+    if (column >= 0)
+        addPoint();
+
+    if (closed && !m_spectrumPath.isEmpty())
+    {
+        m_spectrumPath.lineTo(column, m_endPosY);
+        m_spectrumPath.lineTo(firstColumn, m_endPosY);
+        m_spectrumPath.closeSubPath();
+    }
+}
+
+int BodeMagnitudeComponent::overlayToCoordsY(float value, OverlayScales scale)
+{
+    float scaleValue;
+    switch (scale)
+    {
+    case OverlayScales::magnitudeScale:
+        return scaleToCoordsY(value);
+    case OverlayScales::coherenceScale:
+        scaleValue = jlimit(0.f, 1.f, value);
+        break;
+    default:
+        scaleValue = (jlimit(SPECTRUM_DISPLAY_MIN_DB, SPECTRUM_DISPLAY_MAX_DB, value) - SPECTRUM_DISPLAY_MIN_DB)
+            / (SPECTRUM_DISPLAY_MAX_DB - SPECTRUM_DISPLAY_MIN_DB);
+        break;
+    }
+    return static_cast<int>((1.f - scaleValue) * (m_endPosY - m_startPosY)) + m_startPosY;
+}
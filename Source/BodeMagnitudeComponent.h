@@ -14,6 +14,13 @@
 
 #include <JuceHeader.h>
 #include "ScaledPlot.h"
+#include "SpectrumAnalyser.h"
+
+// the live spectrum has its own level scale (dBFS), independent of the magnitude axis
+#define SPECTRUM_DISPLAY_MIN_DB -96.f
+#define SPECTRUM_DISPLAY_MAX_DB 0.f
+// the measured transfer function is hidden where the coherence is lower
+#define SPECTRUM_MIN_COHERENCE 0.5f
 
 //==============================================================================
 /*
@@ -29,9 +36,49 @@ public:
 
     void setSamplingRate(float fs)
     {
-        m_maxValueX = fs;
-        m_valueStepX = (m_maxValueX - m_minValueX) / 6;
+        // also resets the zoom
+        setFullRangeX(0.0, fs);
+    };
+
+    enum AnalyserModes
+    {
+        analyserOff,
+        // live input and output spectrum
+        analyserSpectrum,
+        // measured transfer function and coherence
+        analyserTransfer,
+        nrofanalysermodes
     };
+    AnalyserModes getAnalyserMode() const { return m_analyserMode; };
+    // called when the analyser button switches the analyser on or off
+    std::function<void(bool)> analyserToggled;
+
+    // latest result of the SpectrumAnalyser
+    void setSpectrum(const SpectrumAnalyser::Spectrum& spectrum);
+    void clearSpectrum();
+
+protected:
+    void paintOverlay(Graphics& g) override;
+
 private:
+    AnalyserModes m_analyserMode;
+    TextButton m_analyserButton;
+    void setAnalyserMode(AnalyserModes mode);
+
+    SpectrumAnalyser::Spectrum m_spectrum;
+    Path m_spectrumPath;
+
+    enum OverlayScales
+    {
+        levelScale,
+        magnitudeScale,
+        coherenceScale
+    };
+    // one point per pixel column (the highest value), closed to the bottom for a filled area
+    // bands with a coherence below SPECTRUM_MIN_COHERENCE are left out if coherence is given
+    void overlayToPath(const std::vector<float>& values, OverlayScales scale, bool closed,
+        const std::vector<float>* coherence = nullptr);
+    int overlayToCoordsY(float value, OverlayScales scale);
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BodeMagnitudeComponent)
 };
@@ -16,15 +16,14 @@
 
 //==============================================================================
 BodePhaseComponent::BodePhaseComponent(bool withAutoScale)
-    : ScaledPlot(withAutoScale)
+    : ScaledPlot(withAutoScale), m_mode(PhaseModes::wrapped)
 {
     // In your constructor, you should add any child components, and
     // initialise any special settings that your component needs.
     m_axisLabelLogX = String("Frequency / Hz");
     m_axisLabelX = String("Frequency / kHz");
-    m_minValueX = 0.0f;
-    m_maxValueX = 10000.0f;
-    m_valueStepX = 1000.0f;
+    setFullRangeX(0.0, 10000.0);
+    m_withZoom = true;
 
     m_axisLabelY = String("Phase / degrees");
     m_minValueY = -180.0f;
@@ -32,6 +31,16 @@ BodePhaseComponent::BodePhaseComponent(bool withAutoScale)
     m_valueStepY = 90.0f;
 
     addAndMakeVisible(m_logButton);
+
+    m_modeButton.setButtonText("phase");
+    m_modeButton.setColour(TextButton::ColourIds::buttonColourId, Colours::darkgreen);
+    m_modeButton.onClick = [this]()
+    {
+        setMode(static_cast<PhaseModes>((m_mode + 1) % PhaseModes::nrofmodes));
+        if (modeChanged != nullptr)
+            modeChanged();
+    };
+    addAndMakeVisible(m_modeButton);
 }
 
 BodePhaseComponent::~BodePhaseComponent()
@@ -50,9 +59,49 @@ void BodePhaseComponent::paint (Graphics& g)
     ScaledPlot::paint(g);
 }
 
+void BodePhaseComponent::setMode(PhaseModes mode)
+{
+    m_mode = mode;
+    switch (mode)
+    {
+    case PhaseModes::wrapped:
+        m_modeButton.setButtonText("phase");
+        m_axisLabelY = String("Phase / degrees");
+        m_withAutoScale = false;
+        m_withAutoStepY = false;
+        m_minValueY = -180.0f;
+        m_maxValueY = 180.0f;
+        m_valueStepY = 90.0f;
+        break;
+    case PhaseModes::unwrapped:
+        m_modeButton.setButtonText("unwr.");
+        m_axisLabelY = String("Unwrapped phase / degrees");
+        m_withAutoScale = true;
+        m_withAutoStepY = true;
+        break;
+    case PhaseModes::groupDelay:
+        m_modeButton.setButtonText("gd");
+        m_axisLabelY = String("Group delay / samples");
+        m_withAutoScale = true;
+        m_withAutoStepY = true;
+        break;
+    case PhaseModes::phaseDelay:
+        m_modeButton.setButtonText("pd");
+        m_axisLabelY = String("Phase delay / samples");
+        m_withAutoScale = true;
+        m_withAutoStepY = true;
+        break;
+    default:
+        break;
+    }
+    axisChanged();
+}
+
 void BodePhaseComponent::resized()
 {
     ScaledPlot::resized();
+    m_modeButton.setBounds(getLocalBounds().removeFromBottom(BUTTON_HEIGHT)
+        .removeFromRight(BUTTON_WIDTH + BUTTON_PADDING).reduced(BUTTON_PADDING));
     // This method is where you should set the bounds of any child
     // components that your component contains..
 
@@ -35,12 +35,29 @@ public:
     void paint (Graphics&) override;
     void resized() override;
 
+    // wrapped and unwrapped phase, group and phase delay (in samples)
+    enum PhaseModes
+    {
+        wrapped,
+        unwrapped,
+        groupDelay,
+        phaseDelay,
+        nrofmodes
+    };
+    void setMode(PhaseModes mode);
+    PhaseModes getMode() const { return m_mode; };
+    // called after the mode button changed the mode, the owner sets the matching data
+    std::function<void()> modeChanged;
+
     void setSamplingRate(float fs) 
-    { 
-        m_maxValueX = fs; 
-        m_valueStepX = (m_maxValueX - m_minValueX) / 6; 
+    {
+        // also resets the zoom
+        setFullRangeX(0.0, fs);
     };
 
 private:
+    PhaseModes m_mode;
+    TextButton m_modeButton;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BodePhaseComponent)
 };
@@ -10,6 +10,8 @@
 */
 
 #include "BrickwallLimiter.h"
+#include "FastMath.h"
+#include "TransferFunLookAndFeel.h"
 
 #include <cmath>
 #include <iostream>
@@ -18,14 +20,16 @@
 
 template <class T> BrickwallLimiter<T>::BrickwallLimiter()
 :m_fs(48000.0),m_nrofchannels(2),m_Limit(1.0),m_attackTime_ms(2.0),m_releaseTime_ms(2000.0),m_Gain(1.0),
-m_attackCounter(0),m_state(BrickwallLimiter::State::Off),m_bypass(false)
+m_attackCounter(0),m_state(BrickwallLimiter::State::Off),m_bypass(false),m_blockMinGain(1.0),m_historyActive(false)
 {
+    m_history.resize(LIMITER_HISTORY_FIFO_SIZE);
     buildAndResetDelayLine();
 }
 template <class T> BrickwallLimiter<T>::BrickwallLimiter(T sampleRate)
 :m_fs(sampleRate),m_nrofchannels(2), m_Limit(1.0),m_attackTime_ms(2.0),m_releaseTime_ms(2000.0),m_Gain(1.0),
-m_attackCounter(0),m_state(BrickwallLimiter::State::Off),m_bypass(false)
+m_attackCounter(0),m_state(BrickwallLimiter::State::Off),m_bypass(false),m_blockMinGain(1.0),m_historyActive(false)
 {
+    m_history.resize(LIMITER_HISTORY_FIFO_SIZE);
     buildAndResetDelayLine();
 }
 
@@ -36,12 +40,11 @@ m_attackCounter(0),m_state(BrickwallLimiter::State::Off),m_bypass(false)
     buildAndResetDelayLine();
 }//*/
 
-double g_maxValLimit(10000000.0);
-
 template <class T> int BrickwallLimiter<T>::processSamples(std::vector<std::vector<T>>& data)
 {
     size_t nrOfInputChannels= data.size();
     size_t nrOfSamples = data[0].size();
+    m_blockMinGain = m_Gain;
 
     for (auto kk = 0; kk < nrOfSamples; ++kk)
     {
@@ -49,12 +52,8 @@ template <class T> int BrickwallLimiter<T>::processSamples(std::vector<std::vect
         // put the input into delay and look for maximum over all channels
         for (auto cc = 0; cc < nrOfInputChannels; ++cc)
         {
+            // no clamping here, NaN/Inf and runaway values are removed per block by the processor
             T inVal = data[cc][kk];
-            if (inVal > g_maxValLimit)
-                inVal = g_maxValLimit;
-            
-            if (inVal < -g_maxValLimit)
-                inVal = -g_maxValLimit;
 
             m_delayline.at(cc).push(inVal);
             if (fabs(inVal)>maxVal)
@@ -178,6 +177,7 @@ template <class T> int BrickwallLimiter<T>::processSamples(std::vector<std::vect
               
         }
     }
+    publishBlockGain(static_cast<int>(nrOfSamples));
     return 0;
 }
 
@@ -187,18 +187,15 @@ template <class T> int BrickwallLimiter<T>::processSamples(juce::AudioBuffer<T>&
     auto readPointer = data.getArrayOfReadPointers();
     auto writePointer = data.getArrayOfWritePointers();
     size_t nrOfSamples = static_cast<size_t>(data.getNumSamples());
+    m_blockMinGain = m_Gain;
     for (auto kk = 0; kk < nrOfSamples; ++kk)
     {
         T maxVal = -1000.f;
         // put the input into delay and look for maximum over all channels
         for (auto cc = 0; cc < totalNrChannels; ++cc)
         {
+            // no clamping here, NaN/Inf and runaway values are removed per block by the processor
             T inVal = readPointer[cc][kk];
-            if (inVal > g_maxValLimit)
-                inVal = g_maxValLimit;
-            
-            if (inVal < -g_maxValLimit)
-                inVal = -g_maxValLimit;
 
             m_delayline.at(cc).push(inVal);
             if (fabs(inVal)>maxVal)
@@ -220,6 +217,7 @@ template <class T> int BrickwallLimiter<T>::processSamples(juce::AudioBuffer<T>&
     
     
     }
+    publishBlockGain(static_cast<int>(nrOfSamples));
     return 0;
 }
 
@@ -260,26 +258,135 @@ int BrickwallLimiterParameter::addParameter(std::vector < std::unique_ptr<Ranged
 }
 
 template <class T> BrickwallLimiterComponent<T>::BrickwallLimiterComponent(AudioProcessorValueTreeState& vts, BrickwallLimiter<T>& limiter)
-: m_limiter(limiter), somethingChanged(nullptr),m_vts(vts),m_scaleFactor(1.f)
+: somethingChanged(nullptr),m_vts(vts),m_limiter(limiter),m_scaleFactor(1.f),m_writeColumn(0),
+m_columnMinGain(1),m_columnSamples(0),m_backgroundIsValid(false)
 {
+    m_readBuffer.resize(LIMITER_HISTORY_FIFO_SIZE);
+    setOpaque(true);
+    m_limiter.setHistoryActive(true);
+}
+
+template <class T> BrickwallLimiterComponent<T>::~BrickwallLimiterComponent()
+{
+    m_limiter.setHistoryActive(false);
+}
 
+template <class T> void BrickwallLimiterComponent<T>::updateFromLimiter()
+{
+    int nrofentries = m_limiter.readGainHistory(m_readBuffer.data(), static_cast<int>(m_readBuffer.size()));
+    if (m_columns_dB.empty())
+        return;
+
+    int nrofcolumns = static_cast<int>(m_columns_dB.size());
+    int samplesPerColumn = jmax(1, static_cast<int>(m_limiter.getSampleRate() * LIMITER_HISTORY_SECONDS / nrofcolumns));
+    bool newColumn = false;
+    for (auto kk = 0; kk < nrofentries; ++kk)
+    {
+        const auto& entry = m_readBuffer[kk];
+        m_columnMinGain = jmin(m_columnMinGain, entry.minGain);
+        m_columnSamples += entry.nrofsamples;
+        // a long block can fill more than one column
+        while (m_columnSamples >= samplesPerColumn)
+        {
+            float gain = static_cast<float>(m_columnMinGain);
+            m_columns_dB[m_writeColumn] = -fastPowerTodB(gain * gain + 1e-12f);
+            m_writeColumn = (m_writeColumn + 1) % nrofcolumns;
+            m_columnSamples -= samplesPerColumn;
+            m_columnMinGain = m_columnSamples > 0 ? entry.minGain : T(1);
+            newColumn = true;
+        }
+    }
+    if (newColumn)
+        repaint(m_plotBounds);
 }
 
 template <class T> void BrickwallLimiterComponent<T>::paint(Graphics& g) 
 {
-    // Reduction anzeige malen
+    // rendered in physical pixels, so it stays sharp on high dpi displays
+    auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    int width = roundToInt(getWidth()*scale);
+    int height = roundToInt(getHeight()*scale);
+    if (width <= 0 || height <= 0)
+        return;
+
+    if (!m_backgroundIsValid || m_background.getWidth() != width || m_background.getHeight() != height)
+    {
+        m_background = Image(Image::RGB, width, height, false);
+        Graphics imageGraphics(m_background);
+        imageGraphics.addTransform(AffineTransform::scale(scale));
+        paintBackground(imageGraphics);
+        m_backgroundIsValid = true;
+    }
+    g.drawImage(m_background, getLocalBounds().toFloat());
+
+    // reduction as an area hanging down from 0 dB, the oldest column on the left
+    int nrofcolumns = static_cast<int>(m_columns_dB.size());
+    if (nrofcolumns == 0)
+        return;
+
+    m_historyPath.clear();
+    m_historyPath.preallocateSpace(3 * (nrofcolumns + 3));
+    float top = static_cast<float>(m_plotBounds.getY());
+    float x = static_cast<float>(m_plotBounds.getX());
+    m_historyPath.startNewSubPath(x, top);
+    for (auto kk = 0; kk < nrofcolumns; ++kk, x += 1.f)
+        m_historyPath.lineTo(x, reductionToY(m_columns_dB[(m_writeColumn + kk) % nrofcolumns]));
+    m_historyPath.lineTo(x, top);
+    m_historyPath.closeSubPath();
+
+    g.setColour(Colours::orange);
+    g.fillPath(m_historyPath);
+}
+
+template <class T> void BrickwallLimiterComponent<T>::paintBackground(Graphics& g)
+{
+    g.fillAll(getLookAndFeel().findColour(ResizableWindow::backgroundColourId).darker(0.2));
+
+    g.setFont(FontSize_small);
+    g.setColour(AxisTextColour);
+    auto labelBounds = getLocalBounds().withRight(m_plotBounds.getX() - 2);
+    g.drawText("GR", labelBounds.removeFromTop(static_cast<int>(FontSize_small) + 2), Justification::centredRight);
 
+    g.setColour(JadeGray.darker(0.5));
+    g.fillRect(m_plotBounds);
+
+    // reduction grid
+    for (float reduction = LIMITER_HISTORY_GRID_DB; reduction <= LIMITER_HISTORY_RANGE_DB; reduction += LIMITER_HISTORY_GRID_DB)
+    {
+        int y = static_cast<int>(reductionToY(reduction));
+        g.setColour(JadeGray);
+        g.drawHorizontalLine(y, static_cast<float>(m_plotBounds.getX()), static_cast<float>(m_plotBounds.getRight()));
+        g.setColour(AxisTextColour);
+        g.drawText(String(-static_cast<int>(reduction)), labelBounds.withY(y - 6).withHeight(12), Justification::centredRight);
+    }
+
+    g.setColour(BorderColour);
+    g.drawRect(m_plotBounds);
 }
+
 template <class T> void BrickwallLimiterComponent<T>::resized()
 {
-    // oben onoff button
-
-    // dadrunter Reduction
+    m_plotBounds = getLocalBounds().reduced(2).withTrimmedLeft(24);
+
+    // the history starts from scratch for a new width, without the blocks that are still queued
+    m_limiter.dropGainHistory();
+    m_columns_dB.assign(static_cast<size_t>(jmax(0, m_plotBounds.getWidth())), 0.f);
+    m_writeColumn = 0;
+    m_columnMinGain = T(1);
+    m_columnSamples = 0;
+    m_backgroundIsValid = false;
+}
 
+template <class T> float BrickwallLimiterComponent<T>::reductionToY(float reduction_dB) const
+{
+    float norm = jlimit(0.f, 1.f, reduction_dB / LIMITER_HISTORY_RANGE_DB);
+    return m_plotBounds.getY() + norm * m_plotBounds.getHeight();
 }
+
 // explicit instantiations
 template class BrickwallLimiter<float>;
 template class BrickwallLimiter<double>;
+template class BrickwallLimiterComponent<float>;
 
 
 // debug code
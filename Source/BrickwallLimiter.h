@@ -11,10 +11,18 @@
 
 #pragma once
 
+#include <atomic>
 #include <vector>
 #include <queue>
 #include <JuceHeader.h>
 
+// number of blocks in the gain history (approx. 20 s for blocks of 512 samples at 48 kHz)
+#define LIMITER_HISTORY_FIFO_SIZE 2048
+// the gain history display shows the last seconds with a gain reduction scale down to
+#define LIMITER_HISTORY_SECONDS 10.0
+#define LIMITER_HISTORY_RANGE_DB 24.f
+#define LIMITER_HISTORY_GRID_DB 6.f
+
 class BrickwallLimiterParameter
 {
 public:
@@ -45,8 +53,33 @@ public:
     void setSampleRate(T samplerate){m_fs = samplerate;m_alphaRelease = exp(-1.f/(m_releaseTime_ms*0.001f*m_fs));};
     T getReduction(){return m_curReduction;};
     int getDelaySamples(){return m_delaySamples;};
+    // the delay line starts with m_delaySamples-1 samples, also in bypass
+    int getLatencySamples() const {return m_delaySamples - 1;};
     T getReduction_db(){return 20.0*log10(m_Gain+0.00000001);};
     void setBypass(bool bypass){m_bypass = bypass;};
+    T getSampleRate() const {return m_fs;};
+
+    // lowest gain of one processed block (1 if nothing was limited or the limiter is bypassed)
+    struct GainHistoryEntry
+    {
+        T minGain;
+        int nrofsamples;
+    };
+    // message thread: the history is only written while a reader is active
+    void setHistoryActive(bool active) { m_historyActive = active; };
+    // message thread: drops the entries that were not read yet (e.g. written before a reader stopped)
+    void dropGainHistory() { m_historyFifo.finishedRead(m_historyFifo.getNumReady()); };
+    // message thread: takes the blocks since the last call out of the lock-free history,
+    // returns the number of entries
+    int readGainHistory(GainHistoryEntry* entries, int maxEntries)
+    {
+        int start1, size1, start2, size2;
+        m_historyFifo.prepareToRead(maxEntries, start1, size1, start2, size2);
+        std::copy(m_history.begin() + start1, m_history.begin() + start1 + size1, entries);
+        std::copy(m_history.begin() + start2, m_history.begin() + start2 + size2, entries + size1);
+        m_historyFifo.finishedRead(size1 + size2);
+        return size1 + size2;
+    };
 private:
     enum class State
     {
@@ -73,6 +106,23 @@ private:
     BrickwallLimiter::State m_state;
     void buildAndResetDelayLine();
     BrickwallLimiterParameter m_brickwallLimiterparamter;
+
+    // the gain only falls in the attack state, so the minimum is only tracked there
+    T m_blockMinGain;
+    std::atomic<bool> m_historyActive;
+    AbstractFifo m_historyFifo { LIMITER_HISTORY_FIFO_SIZE };
+    std::vector<GainHistoryEntry> m_history;
+    void publishBlockGain(int nrofsamples)
+    {
+        if (!m_historyActive.load(std::memory_order_relaxed))
+            return;
+
+        int start1, size1, start2, size2;
+        m_historyFifo.prepareToWrite(1, start1, size1, start2, size2);
+        if (size1 > 0)
+            m_history[start1] = { m_bypass ? T(1) : m_blockMinGain, nrofsamples };
+        m_historyFifo.finishedWrite(size1);
+    };
     inline void processOneMaxVal(T maxVal)
     {
         T maxValwithGain = maxVal*(m_Gain);
@@ -148,6 +198,8 @@ private:
             break;
         case BrickwallLimiter::State::Att:
             m_Gain += m_attackIncrement;
+            if (m_Gain < m_blockMinGain)
+                m_blockMinGain = m_Gain;
             m_attackCounter--;
             if (m_attackCounter <= 0)
             {
@@ -189,27 +241,40 @@ const struct
 	float defaultValue = 1.f;
 }paramBrickwallLimiterOnOff;
 
-template <class T> class BrickwallLimiterComponent : public Component, public Timer
+template <class T> class BrickwallLimiterComponent : public Component
 {
 public:
 	BrickwallLimiterComponent(AudioProcessorValueTreeState& , BrickwallLimiter<T> & );
+	~BrickwallLimiterComponent();
 
 	void paint(Graphics& g) override;
 	void resized() override;
     std::function<void()> somethingChanged;
     void setScaleFactor(float newscale){m_scaleFactor = newscale;};
-    void timerCallback() override
-    {
-        m_reduction = m_limiter.getReduction_db();
-        repaint();
-    };
+    // polled once per frame by the GUI (see InvalidationScheduler),
+    // scrolls and repaints when a new column of the history is complete
+    void updateFromLimiter();
 private:
     AudioProcessorValueTreeState& m_vts; 
     BrickwallLimiter<T>& m_limiter;
-    ToggleButton m_onoff;
-    float m_reduction;
     float m_scaleFactor;
 
+    std::vector<typename BrickwallLimiter<T>::GainHistoryEntry> m_readBuffer;
+    // gain reduction in dB per pixel column, ring buffer with the oldest column at m_writeColumn
+    std::vector<float> m_columns_dB;
+    int m_writeColumn;
+    // the column that is not complete yet
+    T m_columnMinGain;
+    int m_columnSamples;
+
+    Rectangle<int> m_plotBounds;
+    Path m_historyPath;
+    float reductionToY(float reduction_dB) const;
+
+    // grid and labels only change with the size, they are drawn once into this image
+    Image m_background;
+    bool m_backgroundIsValid;
+    void paintBackground(Graphics& g);
 };
 
 // BrickwallLimiter<float> blf;
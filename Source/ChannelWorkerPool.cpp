@@ -0,0 +1,181 @@
+/*
+  ==============================================================================
+    ChannelWorkerPool.cpp
+
+    Authors:    agent
+
+    SPDX-License-Identifier: BSD-3-Clause
+ ==============================================================================
+*/
+
+#include <thread>
+#include "ChannelWorkerPool.h"
+
+#if JUCE_MAC || JUCE_IOS
+ #include <dispatch/dispatch.h>
+#elif JUCE_WINDOWS
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #include <windows.h>
+#else
+ #include <semaphore.h>
+#endif
+
+// busy waiting before parking, a small fraction of a block period
+#define WORKER_SPIN_TIME_US 20
+// the clock is only read every n spins
+#define WORKER_SPIN_CHECK_COUNT 64
+
+#if JUCE_MAC || JUCE_IOS
+WakeSemaphore::WakeSemaphore() : m_handle(dispatch_semaphore_create(0)) {}
+WakeSemaphore::~WakeSemaphore() { dispatch_release(static_cast<dispatch_semaphore_t>(m_handle)); }
+void WakeSemaphore::post() { dispatch_semaphore_signal(static_cast<dispatch_semaphore_t>(m_handle)); }
+void WakeSemaphore::wait() { dispatch_semaphore_wait(static_cast<dispatch_semaphore_t>(m_handle), DISPATCH_TIME_FOREVER); }
+#elif JUCE_WINDOWS
+WakeSemaphore::WakeSemaphore() : m_handle(CreateSemaphore(nullptr, 0, 0x7fffffff, nullptr)) {}
+WakeSemaphore::~WakeSemaphore() { CloseHandle(m_handle); }
+void WakeSemaphore::post() { ReleaseSemaphore(m_handle, 1, nullptr); }
+void WakeSemaphore::wait() { WaitForSingleObject(m_handle, INFINITE); }
+#else
+WakeSemaphore::WakeSemaphore() : m_handle(new sem_t) { sem_init(static_cast<sem_t*>(m_handle), 0, 0); }
+WakeSemaphore::~WakeSemaphore()
+{
+    sem_destroy(static_cast<sem_t*>(m_handle));
+    delete static_cast<sem_t*>(m_handle);
+}
+void WakeSemaphore::post() { sem_post(static_cast<sem_t*>(m_handle)); }
+void WakeSemaphore::wait()
+{
+    // retry if a signal interrupted the wait
+    while (sem_wait(static_cast<sem_t*>(m_handle)) != 0) {}
+}
+#endif
+
+ChannelWorkerPool::ChannelWorkerPool()
+:m_job(nullptr),m_nrofchannels(0),m_generation(0),m_nextChannel(0),m_channelsDone(0),
+m_activeWorkers(0),m_sleepingWorkers(0),m_exit(false)
+{
+}
+
+ChannelWorkerPool::~ChannelWorkerPool()
+{
+    stop();
+}
+
+void ChannelWorkerPool::start(int nrofworkers)
+{
+    if (nrofworkers == getNumWorkers())
+        return;
+
+    stop();
+    m_exit = false;
+    for (auto kk = 0; kk < nrofworkers; ++kk)
+    {
+        m_workers.push_back(std::make_unique<Worker>(*this));
+        m_workers.back()->startThread(10);
+    }
+}
+
+void ChannelWorkerPool::stop()
+{
+    if (m_workers.empty())
+        return;
+
+    for (auto& worker : m_workers)
+        worker->signalThreadShouldExit();
+    m_exit = true;
+    // one token per worker, parked or not
+    for (auto kk = 0U; kk < m_workers.size(); ++kk)
+        m_wakeSemaphore.post();
+    for (auto& worker : m_workers)
+        worker->stopThread(1000);
+
+    m_workers.clear();
+}
+
+void ChannelWorkerPool::run(Job& job, int nrofchannels, int nrofsamples)
+{
+    if (m_workers.empty() || nrofchannels < PARALLEL_MIN_CHANNELS || nrofsamples < PARALLEL_MIN_BLOCKSIZE)
+    {
+        for (auto cc = 0; cc < nrofchannels; ++cc)
+            job.processChannel(cc);
+        return;
+    }
+
+    // a worker that woke up late for the last block must leave before the counters are reset
+    while (m_activeWorkers.load(std::memory_order_seq_cst) > 0)
+        std::this_thread::yield();
+
+    // publish the job, the release store of m_nextChannel makes it visible to every claim
+    m_job.store(&job, std::memory_order_relaxed);
+    m_nrofchannels.store(nrofchannels, std::memory_order_relaxed);
+    m_channelsDone.store(0, std::memory_order_relaxed);
+    m_nextChannel.store(0, std::memory_order_release);
+    m_generation.fetch_add(1, std::memory_order_seq_cst);
+
+    wakeSleepingWorkers();
+
+    // the audio thread works as well, so a slow wake up never blocks the block
+    processChannels();
+
+    while (m_channelsDone.load(std::memory_order_acquire) < nrofchannels)
+        std::this_thread::yield();
+}
+
+void ChannelWorkerPool::processChannels()
+{
+    int channel;
+    while ((channel = m_nextChannel.fetch_add(1, std::memory_order_acq_rel)) < m_nrofchannels.load(std::memory_order_relaxed))
+    {
+        m_job.load(std::memory_order_relaxed)->processChannel(channel);
+        m_channelsDone.fetch_add(1, std::memory_order_release);
+    }
+}
+
+void ChannelWorkerPool::wakeSleepingWorkers()
+{
+    // a worker registers as sleeping before it checks the generation a last time, so either it
+    // sees the new generation or it is counted here (an extra token only causes a spurious wake up)
+    int sleeping = m_sleepingWorkers.load(std::memory_order_seq_cst);
+    for (auto kk = 0; kk < sleeping; ++kk)
+        m_wakeSemaphore.post();
+}
+
+void ChannelWorkerPool::workerLoop(Worker& worker)
+{
+    const int64 spinTicks = jmax(static_cast<int64>(1),
+        Time::getHighResolutionTicksPerSecond() * WORKER_SPIN_TIME_US / 1000000);
+    uint32 seenGeneration = m_generation.load(std::memory_order_acquire);
+    while (!worker.threadShouldExit())
+    {
+        int spins = 0;
+        int64 spinStart = Time::getHighResolutionTicks();
+        uint32 generation;
+        while ((generation = m_generation.load(std::memory_order_acquire)) == seenGeneration)
+        {
+            if (worker.threadShouldExit() || m_exit.load())
+                return;
+
+            if (++spins < WORKER_SPIN_CHECK_COUNT)
+                continue;
+            spins = 0;
+            if (Time::getHighResolutionTicks() - spinStart < spinTicks)
+                continue;
+
+            // no new block within the spin time, park until the audio thread posts
+            m_sleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+            if (m_generation.load(std::memory_order_seq_cst) == seenGeneration && !m_exit.load())
+                m_wakeSemaphore.wait();
+            m_sleepingWorkers.fetch_sub(1, std::memory_order_seq_cst);
+            spinStart = Time::getHighResolutionTicks();
+        }
+        seenGeneration = generation;
+
+        // register first, then make sure the block is still the one we woke up for
+        m_activeWorkers.fetch_add(1, std::memory_order_seq_cst);
+        if (m_generation.load(std::memory_order_seq_cst) == generation)
+            processChannels();
+        m_activeWorkers.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
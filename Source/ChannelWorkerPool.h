@@ -0,0 +1,99 @@
+/*
+  ==============================================================================
+    ChannelWorkerPool.h
+
+    A small pool of audio worker threads to process independent channels of
+    one block in parallel. The calling (audio) thread takes part in the work
+    and returns when all channels are done. The handoff is lock free: workers
+    spin on a generation counter for a few microseconds (a fraction of a
+    block period) and then park on a semaphore. The audio thread wakes them
+    with a semaphore post, which never takes a lock.
+
+    Authors:    agent
+
+    SPDX-License-Identifier: BSD-3-Clause
+ ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <JuceHeader.h>
+
+// below these limits the handoff costs more than it saves
+#define PARALLEL_MIN_CHANNELS 4
+#define PARALLEL_MIN_BLOCKSIZE 64
+
+// counting semaphore on the native primitive (futex, kernel object), post() is lock free
+class WakeSemaphore
+{
+public:
+    WakeSemaphore();
+    ~WakeSemaphore();
+    void post();
+    void wait();
+private:
+    void* m_handle;
+    JUCE_DECLARE_NON_COPYABLE (WakeSemaphore)
+};
+
+class ChannelWorkerPool
+{
+public:
+    // work to be done, processChannel is called exactly once per channel
+    class Job
+    {
+    public:
+        virtual ~Job() = default;
+        virtual void processChannel(int channel) = 0;
+    };
+
+    ChannelWorkerPool();
+    ~ChannelWorkerPool();
+
+    /** starts nrofworkers threads (in addition to the calling thread), 0 stops the pool */
+    void start(int nrofworkers);
+    void stop();
+    int getNumWorkers() const { return static_cast<int>(m_workers.size()); };
+
+    /**
+     * processes channel 0 ... nrofchannels-1 and returns after the last one is done.
+     * Falls back to a serial loop if no workers run or the work is too small.
+     */
+    void run(Job& job, int nrofchannels, int nrofsamples);
+
+private:
+    class Worker : public Thread
+    {
+    public:
+        Worker(ChannelWorkerPool& pool) : Thread("FDM channel worker"), m_pool(pool) {};
+        void run() override
+        {
+            ScopedNoDenormals noDenormals;
+            m_pool.workerLoop(*this);
+        };
+    private:
+        ChannelWorkerPool& m_pool;
+    };
+
+    void workerLoop(Worker& worker);
+    void processChannels();
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+
+    std::atomic<Job*> m_job;
+    std::atomic<int> m_nrofchannels;
+    std::atomic<uint32> m_generation;
+    std::atomic<int> m_nextChannel;
+    std::atomic<int> m_channelsDone;
+    std::atomic<int> m_activeWorkers;
+
+    // parking of idle workers
+    std::atomic<int> m_sleepingWorkers;
+    std::atomic<bool> m_exit;
+    WakeSemaphore m_wakeSemaphore;
+    void wakeSleepingWorkers();
+
+    JUCE_DECLARE_NON_COPYABLE (ChannelWorkerPool)
+};
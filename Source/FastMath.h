@@ -0,0 +1,94 @@
+/*
+  ==============================================================================
+    FastMath.h
+
+    Cheap approximations of transcendental functions for control rate and
+    display computations, where a small error is acceptable.
+
+    Authors:    agent
+
+    SPDX-License-Identifier: BSD-3-Clause
+ ==============================================================================
+*/
+
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+const float g_fastPi = 3.14159265358979323846f;
+const float g_fastTwoPi = 2.f*g_fastPi;
+
+/**
+ * wraps the angle to [-pi, pi)
+ */
+inline float fastWrapAngle(float x)
+{
+    return x - g_fastTwoPi*std::floor((x + g_fastPi)*(1.f/g_fastTwoPi));
+}
+
+/**
+ * parabolic sine approximation with one refinement step (max. error approx. 1e-3)
+ */
+inline float fastSin(float x)
+{
+    x = fastWrapAngle(x);
+    const float B = 4.f/g_fastPi;
+    const float C = -4.f/(g_fastPi*g_fastPi);
+    float y = B*x + C*x*std::abs(x);
+    return 0.225f*(y*std::abs(y) - y) + y;
+}
+
+inline float fastCos(float x)
+{
+    return fastSin(x + 0.5f*g_fastPi);
+}
+
+/**
+ * log2 for x > 0 (x is limited to 1e-30): exponent from the bit pattern and
+ * atanh series of the mantissa (max. error approx. 1e-6). Written without
+ * branches, so loops over arrays vectorise.
+ */
+inline float fastLog2(float x)
+{
+    x = x < 1e-30f ? 1e-30f : x;
+    int32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    float exponent = static_cast<float>(((bits >> 23) & 255) - 127);
+    bits = (bits & 0x007FFFFF) | 0x3F800000;
+    float m;
+    std::memcpy(&m, &bits, sizeof(m));
+
+    // ln(m) = 2 atanh((m-1)/(m+1)), m in [1,2)
+    float y = (m - 1.f)/(m + 1.f);
+    float y2 = y*y;
+    float lnm = 2.f*y*(1.f + y2*(1.f/3.f + y2*(1.f/5.f + y2*(1.f/7.f + y2*(1.f/9.f)))));
+    return exponent + lnm*1.44269504088896f;
+}
+
+/**
+ * 10*log10 of a squared magnitude, i.e. the level in dB
+ */
+inline float fastPowerTodB(float x)
+{
+    return 3.01029995663981f*fastLog2(x);
+}
+
+/**
+ * atan2 with a polynomial on [0,1] and octant mapping (max. error approx. 1e-5),
+ * without branches like fastLog2
+ */
+inline float fastAtan2(float y, float x)
+{
+    float ax = std::abs(x);
+    float ay = std::abs(y);
+    float maxVal = ax > ay ? ax : ay;
+    float minVal = ax > ay ? ay : ax;
+    // minVal is 0 if maxVal is 0, the select keeps the division out of a branch
+    float a = minVal/(maxVal > 0.f ? maxVal : 1.f);
+    float s = a*a;
+    float r = ((((0.0208351f*s - 0.0851330f)*s + 0.1801410f)*s - 0.3302995f)*s + 0.9998660f)*a;
+    r = ay > ax ? 0.5f*g_fastPi - r : r;
+    r = x < 0.f ? g_fastPi - r : r;
+    return y < 0.f ? -r : r;
+}
@@ -0,0 +1,145 @@
+/*
+  ==============================================================================
+    FilterModel.cpp
+
+    Authors:    agent
+
+    SPDX-License-Identifier: BSD-3-Clause
+ ==============================================================================
+*/
+
+#include "FilterModel.h"
+
+FilterModelStore::FilterModelStore()
+:m_vts(nullptr),m_version(1),m_gain(nullptr),m_poleProtect(nullptr)
+{
+}
+
+FilterModelStore::~FilterModelStore()
+{
+    detach();
+}
+
+StringArray FilterModelStore::getParameterIDs() const
+{
+    StringArray ids;
+    for (auto kk = 0; kk < MAX_POLE_INSTANCES; ++kk)
+    {
+        ids.add(paramPoleBool.ID[kk]);
+        ids.add(paramPoleConjugated.ID[kk]);
+        ids.add(paramPoleReal.ID[kk]);
+        ids.add(paramPoleImag.ID[kk]);
+        ids.add(paramZeroBool.ID[kk]);
+        ids.add(paramZeroConjugated.ID[kk]);
+        ids.add(paramZeroReal.ID[kk]);
+        ids.add(paramZeroImag.ID[kk]);
+    }
+    ids.add(paramb0.ID);
+    ids.add(paramPoleProtectBool.ID);
+    return ids;
+}
+
+void FilterModelStore::attach(AudioProcessorValueTreeState& vts)
+{
+    detach();
+    m_vts = &vts;
+    for (auto kk = 0; kk < MAX_POLE_INSTANCES; ++kk)
+    {
+        m_poleParams[kk] = { vts.getRawParameterValue(paramPoleBool.ID[kk]),
+            vts.getRawParameterValue(paramPoleConjugated.ID[kk]),
+            vts.getRawParameterValue(paramPoleReal.ID[kk]),
+            vts.getRawParameterValue(paramPoleImag.ID[kk]) };
+        m_zeroParams[kk] = { vts.getRawParameterValue(paramZeroBool.ID[kk]),
+            vts.getRawParameterValue(paramZeroConjugated.ID[kk]),
+            vts.getRawParameterValue(paramZeroReal.ID[kk]),
+            vts.getRawParameterValue(paramZeroImag.ID[kk]) };
+    }
+    m_gain = vts.getRawParameterValue(paramb0.ID);
+    m_poleProtect = vts.getRawParameterValue(paramPoleProtectBool.ID);
+
+    for (auto& id : getParameterIDs())
+        vts.addParameterListener(id, this);
+
+    m_version++;
+}
+
+void FilterModelStore::detach()
+{
+    if (m_vts == nullptr)
+        return;
+
+    for (auto& id : getParameterIDs())
+        m_vts->removeParameterListener(id, this);
+
+    m_vts = nullptr;
+}
+
+void FilterModelStore::parameterChanged(const String& parameterID, float newValue)
+{
+    ignoreUnused(parameterID, newValue);
+    m_version.fetch_add(1, std::memory_order_acq_rel);
+}
+
+std::shared_ptr<const FilterModel> FilterModelStore::getModel()
+{
+    uint32 version = getVersion();
+    {
+        SpinLock::ScopedLockType lock(m_modelLock);
+        if (m_model != nullptr && m_model->version == version)
+            return m_model;
+    }
+    // built outside of the lock, a second reader at worst builds the same model
+    auto model = buildModel(version);
+
+    SpinLock::ScopedLockType lock(m_modelLock);
+    if (m_model == nullptr || m_model->version != getVersion())
+        m_model = model;
+
+    return m_model;
+}
+
+std::shared_ptr<const FilterModel> FilterModelStore::buildModel(uint32 version) const
+{
+    auto model = std::make_shared<FilterModel>();
+    model->version = version;
+    if (m_vts == nullptr)
+        return model;
+
+    for (auto kk = 0; kk < MAX_POLE_INSTANCES; ++kk)
+    {
+        FilterModel::Section& section = model->sections[kk];
+        section.poleOn = *m_poleParams[kk].on > 0.5f;
+        section.poleConj = *m_poleParams[kk].conj > 0.5f;
+        section.pole = { m_poleParams[kk].real->load(), m_poleParams[kk].imag->load() };
+        section.zeroOn = *m_zeroParams[kk].on > 0.5f;
+        section.zeroConj = *m_zeroParams[kk].conj > 0.5f;
+        section.zero = { m_zeroParams[kk].real->load(), m_zeroParams[kk].imag->load() };
+
+        if (section.poleOn)
+        {
+            model->poles.push_back(section.pole);
+            if (section.poleConj)
+                model->poles.push_back(std::conj(section.pole));
+        }
+        if (section.zeroOn)
+        {
+            model->zeros.push_back(section.zero);
+            if (section.zeroConj)
+                model->zeros.push_back(std::conj(section.zero));
+        }
+
+        FilterModel::SOSCoeffs& sos = model->sos[kk];
+        sos.b0 = 1.f;
+        rootToSOSCoeffs(section.zeroOn ? 1.f : 0.f, section.zeroConj ? 1.f : 0.f,
+            section.zero.real(), section.zero.imag(), sos.b1, sos.b2);
+        rootToSOSCoeffs(section.poleOn ? 1.f : 0.f, section.poleConj ? 1.f : 0.f,
+            section.pole.real(), section.pole.imag(), sos.a1, sos.a2);
+    }
+    model->gain_dB = *m_gain;
+    model->gainLin = std::pow(10.f, model->gain_dB/20.f);
+    model->sos[0].b0 *= model->gainLin;
+    model->sos[0].b1 *= model->gainLin;
+    model->sos[0].b2 *= model->gainLin;
+    model->poleProtect = *m_poleProtect > 0.5f;
+    return model;
+}
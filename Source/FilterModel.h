@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+    FilterModel.h
+
+    Versioned snapshot of the filter defined by the pole/zero parameters
+    (sections, expanded poles and zeros, gain and the SOS coefficients).
+    The FilterModelStore listens to the parameters and only increments a
+    version number on a change (realtime safe). The snapshot itself is
+    rebuilt lazily by the first reader that asks for a newer version and is
+    then shared read-only by all views. Readers compare the version to skip
+    their work if nothing changed.
+
+    Authors:    agent
+
+    SPDX-License-Identifier: BSD-3-Clause
+ ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <complex>
+#include <memory>
+#include <vector>
+#include <JuceHeader.h>
+#include "PNParameter.h"
+
+// the processor and the offline analysis (time response) use the same cascade settings
+// sample or state value that is treated as an instable filter (+100 dB), loud but valid
+// levels below are passed on to the limiter
+#define HEALTH_MAX_VALUE 100000.f
+// without pole protection a section may be instable, its recursive part is then hard
+// clipped at SOS_CLIP_VALUE (+26 dB, a loud and distorted signal instead of a runaway)
+#define SOS_CLIP_VALUE 20.f
+inline bool useSectionClipping(bool poleProtect) { return !poleProtect; }
+
+/**
+ * coefficients of one root (pair) of a section: 1 + c1 z^-1 + c2 z^-2
+ * odd filter: 1 - re z^-1, conjugated pair: 1 - 2 re z^-1 + (re^2+im^2) z^-2.
+ * isOn and isConj are 0 or 1, so the function can be used in vectorised loops.
+ */
+inline void rootToSOSCoeffs(float isOn, float isConj, float re, float im, float& c1, float& c2)
+{
+    c1 = -isOn*(1.f + isConj)*re;
+    c2 = isOn*isConj*(re*re + im*im);
+}
+
+/**
+ * pole protection: a section with poles on or outside the unit circle is
+ * rejected, the caller keeps the last accepted coefficients of the section.
+ */
+inline bool isSectionAccepted(bool poleProtect, bool poleConj, float a1, float a2)
+{
+    if (!poleProtect)
+        return true;
+
+    return a2 < 1.f && (poleConj || std::abs(a1) < 0.998f);
+}
+
+struct FilterModel
+{
+    struct Section
+    {
+        bool poleOn, poleConj;
+        bool zeroOn, zeroConj;
+        std::complex<float> pole;
+        std::complex<float> zero;
+    };
+    struct SOSCoeffs
+    {
+        float b0, b1, b2, a1, a2;
+    };
+
+    uint32 version = 0;
+    Section sections[MAX_POLE_INSTANCES];
+    // active roots, conjugates included
+    std::vector<std::complex<float>> poles;
+    std::vector<std::complex<float>> zeros;
+    float gain_dB = 0.f;
+    float gainLin = 1.f;
+    // the gain is part of the first section
+    SOSCoeffs sos[MAX_POLE_INSTANCES];
+    // the sections are not checked here, see isSectionAccepted()
+    bool poleProtect = true;
+};
+
+class FilterModelStore : public AudioProcessorValueTreeState::Listener
+{
+public:
+    FilterModelStore();
+    ~FilterModelStore();
+
+    void attach(AudioProcessorValueTreeState& vts);
+    void detach();
+
+    // incremented on every parameter change, cheap enough for the audio thread
+    uint32 getVersion() const { return m_version.load(std::memory_order_acquire); };
+
+    /**
+     * returns the snapshot of the current parameters (rebuilt if the version
+     * changed). Allocates, do not call from the audio thread.
+     */
+    std::shared_ptr<const FilterModel> getModel();
+
+    void parameterChanged(const String& parameterID, float newValue) override;
+
+private:
+    AudioProcessorValueTreeState* m_vts;
+    std::atomic<uint32> m_version;
+
+    struct RootParameter
+    {
+        std::atomic<float>* on;
+        std::atomic<float>* conj;
+        std::atomic<float>* real;
+        std::atomic<float>* imag;
+    };
+    RootParameter m_poleParams[MAX_POLE_INSTANCES];
+    RootParameter m_zeroParams[MAX_POLE_INSTANCES];
+    std::atomic<float>* m_gain;
+    std::atomic<float>* m_poleProtect;
+
+    SpinLock m_modelLock;
+    std::shared_ptr<const FilterModel> m_model;
+
+    std::shared_ptr<const FilterModel> buildModel(uint32 version) const;
+    StringArray getParameterIDs() const;
+
+    JUCE_DECLARE_NON_COPYABLE (FilterModelStore)
+};
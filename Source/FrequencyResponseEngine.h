@@ -0,0 +1,389 @@
+/*
+  ==============================================================================
+    FrequencyResponseEngine.h
+
+    Evaluates the frequency response of a pole/zero set on the unit circle.
+    The points on the unit circle (twiddles) are computed once, the complex
+    products are done as structure of arrays (real and imaginary part in own
+    arrays), so every loop runs over all frequencies and vectorises. Numerator
+    and denominator are accumulated separately, so the magnitude is a
+    difference of two levels.
+    All buffers are allocated in setNumPoints, never during compute.
+
+    Phase and group delay are sums of per-root terms, accumulated in the same
+    loop as the products. The phase of a root factor 1 - r e^-jw is continuous
+    over w (for |r| > 1 it is written as -r e^-jw (1 - e^jw/r)), so the sum is
+    the unwrapped phase without any unwrapping along the frequency axis, and
+    the group delay is exact instead of a noisy difference of phases:
+        tau_r(w) = (Re(r e^-jw) - |r|^2) / |e^jw - r|^2
+    Phase, unwrapped phase, group and phase delay are the ones of the causal
+    filter (as in the processor), delays are in samples.
+
+    computeAdaptive() samples a frequency range log-spaced and subdivides the
+    intervals where magnitude or phase change fast (high Q poles, notches),
+    so the curve is accurate with few evaluations. Its buffers are reserved
+    for ADAPTIVE_MAX_POINTS once.
+
+    Authors:    agent
+
+    SPDX-License-Identifier: BSD-3-Clause
+ ==============================================================================
+*/
+
+#pragma once
+
+#include <vector>
+#include <complex>
+#include <cmath>
+#include <algorithm>
+#include "FastMath.h"
+
+#define ADAPTIVE_BASE_POINTS 256
+#define ADAPTIVE_MAX_POINTS 2048
+#define ADAPTIVE_MAX_PASSES 6
+#define ADAPTIVE_MAX_STEP_DB 0.5f
+#define ADAPTIVE_MAX_STEP_DEG 5.f
+// lowest frequency of the log spacing if the range starts at 0 (relative to fs)
+#define ADAPTIVE_LOWEST_NORM_FREQ 1e-4f
+#define ADAPTIVE_MIN_INTERVAL 1e-6f
+
+class FrequencyResponseEngine
+{
+public:
+    enum Results
+    {
+        magnitude_dB,
+        phase_deg,
+        unwrappedPhase_deg,
+        groupDelay,
+        phaseDelay,
+        nrofresults
+    };
+
+    FrequencyResponseEngine()
+    :m_nrofpoints(0),m_fullCircle(false)
+    {
+        setNumPoints(1001, false);
+    };
+
+    /**
+     * sets the number of (equally spaced) frequencies from 0 to fs/2 or, if
+     * fullCircle is true, from 0 to fs. Both ends are included.
+     */
+    void setNumPoints(int nrofpoints, bool fullCircle)
+    {
+        if (nrofpoints == m_nrofpoints && fullCircle == m_fullCircle)
+            return;
+
+        m_nrofpoints = nrofpoints;
+        m_fullCircle = fullCircle;
+        m_cos.resize(nrofpoints);
+        m_sin.resize(nrofpoints);
+        m_normFreq.resize(nrofpoints);
+        reserveScratch(nrofpoints);
+        for (auto& result : m_results)
+            result.resize(nrofpoints);
+
+        const double pi = 3.14159265358979323846;
+        double maxAngle = fullCircle ? 2.0*pi : pi;
+        double angleStep = nrofpoints > 1 ? maxAngle/(nrofpoints - 1) : 0.0;
+        for (auto kk = 0; kk < nrofpoints; ++kk)
+        {
+            m_cos[kk] = static_cast<float>(std::cos(kk*angleStep));
+            m_sin[kk] = static_cast<float>(std::sin(kk*angleStep));
+            m_normFreq[kk] = static_cast<float>(kk*angleStep/(2.0*pi));
+        }
+    };
+    int getNumPoints() const { return m_nrofpoints; };
+
+    /**
+     * computes H(e^jw) = gain * prod(1 - z e^-jw) / prod(1 - p e^-jw)
+     */
+    void compute(const std::vector<std::complex<float>>& poles,
+        const std::vector<std::complex<float>>& zeros, float gain_dB)
+    {
+        evaluate(m_normFreq.data(), m_cos.data(), m_sin.data(), m_nrofpoints, poles, zeros, gain_dB,
+            m_results);
+    };
+
+    /**
+     * computes H(e^jw) from minNormFreq to maxNormFreq (relative to fs) on a
+     * log-spaced grid that is refined where the response changes fast. The
+     * number of points depends on the filter, see getNormFrequency().
+     */
+    void computeAdaptive(const std::vector<std::complex<float>>& poles,
+        const std::vector<std::complex<float>>& zeros, float gain_dB,
+        float minNormFreq, float maxNormFreq)
+    {
+        // the linear grid is rebuilt by the next setNumPoints
+        m_nrofpoints = 0;
+        setBaseRange(minNormFreq, maxNormFreq);
+        reserveScratch(ADAPTIVE_MAX_POINTS);
+        reserveAdaptive();
+
+        int N = static_cast<int>(m_baseFreq.size());
+        m_normFreq.assign(m_baseFreq.begin(), m_baseFreq.end());
+        for (auto& result : m_results)
+            result.resize(N);
+        evaluate(m_baseFreq.data(), m_baseCos.data(), m_baseSin.data(), N, poles, zeros, gain_dB,
+            m_results);
+
+        const auto& magnitude = m_results[magnitude_dB];
+        const auto& phase = m_results[phase_deg];
+        for (auto pass = 0; pass < ADAPTIVE_MAX_PASSES; ++pass)
+        {
+            // split every interval with a large step in magnitude or phase
+            m_split.clear();
+            m_newFreq.clear();
+            size_t nrofpoints = m_normFreq.size();
+            for (size_t kk = 0; kk + 1 < nrofpoints; ++kk)
+            {
+                if (nrofpoints + m_newFreq.size() >= ADAPTIVE_MAX_POINTS)
+                    break;
+
+                float f1 = m_normFreq[kk];
+                float f2 = m_normFreq[kk + 1];
+                if (f2 - f1 < ADAPTIVE_MIN_INTERVAL)
+                    continue;
+
+                float magnitudeStep = std::abs(magnitude[kk + 1] - magnitude[kk]);
+                float phaseStep = std::abs(phase[kk + 1] - phase[kk]);
+                phaseStep = std::min(phaseStep, 360.f - phaseStep);
+                if (magnitudeStep <= ADAPTIVE_MAX_STEP_DB && phaseStep <= ADAPTIVE_MAX_STEP_DEG)
+                    continue;
+
+                m_split.push_back(kk);
+                m_newFreq.push_back(f1 > 0.f ? std::sqrt(f1*f2) : 0.5f*(f1 + f2));
+            }
+            if (m_newFreq.empty())
+                break;
+
+            int M = static_cast<int>(m_newFreq.size());
+            m_newCos.resize(M);
+            m_newSin.resize(M);
+            for (auto& result : m_newResults)
+                result.resize(M);
+            for (auto kk = 0; kk < M; ++kk)
+            {
+                double angle = 2.0*3.14159265358979323846*m_newFreq[kk];
+                m_newCos[kk] = static_cast<float>(std::cos(angle));
+                m_newSin[kk] = static_cast<float>(std::sin(angle));
+            }
+            evaluate(m_newFreq.data(), m_newCos.data(), m_newSin.data(), M, poles, zeros, gain_dB,
+                m_newResults);
+
+            // insert the new points behind the split intervals
+            merge(m_normFreq, m_newFreq, m_mergeFreq);
+            for (auto rr = 0; rr < nrofresults; ++rr)
+                merge(m_results[rr], m_newResults[rr], m_mergeResults[rr]);
+        }
+    };
+
+    // frequencies relative to fs (0 ... 0.5 or 0 ... 1)
+    const std::vector<float>& getNormFrequency() const { return m_normFreq; };
+    const std::vector<float>& getResult(Results result) const { return m_results[result]; };
+    const std::vector<float>& getMagnitude_dB() const { return m_results[magnitude_dB]; };
+    const std::vector<float>& getPhase_deg() const { return m_results[phase_deg]; };
+    const std::vector<float>& getUnwrappedPhase_deg() const { return m_results[unwrappedPhase_deg]; };
+    const std::vector<float>& getGroupDelay() const { return m_results[groupDelay]; };
+    const std::vector<float>& getPhaseDelay() const { return m_results[phaseDelay]; };
+
+private:
+    int m_nrofpoints;
+    bool m_fullCircle;
+
+    // points on the unit circle
+    std::vector<float> m_cos;
+    std::vector<float> m_sin;
+    std::vector<float> m_normFreq;
+
+    std::vector<float> m_numRe, m_numIm;
+    std::vector<float> m_denRe, m_denIm;
+    // phase in rad and group delay, summed over the roots
+    std::vector<float> m_phaseSum, m_delaySum;
+
+    std::vector<float> m_results[nrofresults];
+
+    // adaptive sampling: cached log-spaced base grid and the refinement buffers
+    float m_baseMinNormFreq = -1.f;
+    float m_baseMaxNormFreq = -1.f;
+    std::vector<float> m_baseFreq, m_baseCos, m_baseSin;
+    std::vector<size_t> m_split;
+    std::vector<float> m_newFreq, m_newCos, m_newSin;
+    std::vector<float> m_newResults[nrofresults];
+    std::vector<float> m_mergeFreq;
+    std::vector<float> m_mergeResults[nrofresults];
+
+    void reserveScratch(int nrofpoints)
+    {
+        if (static_cast<int>(m_numRe.size()) >= nrofpoints)
+            return;
+
+        m_numRe.resize(nrofpoints);
+        m_numIm.resize(nrofpoints);
+        m_denRe.resize(nrofpoints);
+        m_denIm.resize(nrofpoints);
+        m_phaseSum.resize(nrofpoints);
+        m_delaySum.resize(nrofpoints);
+    };
+
+    // no allocation in computeAdaptive after the first call
+    void reserveAdaptive()
+    {
+        if (m_split.capacity() >= ADAPTIVE_MAX_POINTS)
+            return;
+
+        m_split.reserve(ADAPTIVE_MAX_POINTS);
+        for (auto vec : { &m_normFreq, &m_newFreq, &m_newCos, &m_newSin, &m_mergeFreq })
+            vec->reserve(ADAPTIVE_MAX_POINTS);
+        for (auto rr = 0; rr < nrofresults; ++rr)
+        {
+            m_results[rr].reserve(ADAPTIVE_MAX_POINTS);
+            m_newResults[rr].reserve(ADAPTIVE_MAX_POINTS);
+            m_mergeResults[rr].reserve(ADAPTIVE_MAX_POINTS);
+        }
+    };
+
+    // values gets the new values inserted behind the split positions, scratch is swapped in
+    void merge(std::vector<float>& values, const std::vector<float>& newValues, std::vector<float>& scratch)
+    {
+        scratch.clear();
+        size_t next = 0;
+        for (size_t kk = 0; kk < values.size(); ++kk)
+        {
+            scratch.push_back(values[kk]);
+            if (next < m_split.size() && m_split[next] == kk)
+                scratch.push_back(newValues[next++]);
+        }
+        values.swap(scratch);
+    };
+
+    void setBaseRange(float minNormFreq, float maxNormFreq)
+    {
+        if (minNormFreq == m_baseMinNormFreq && maxNormFreq == m_baseMaxNormFreq)
+            return;
+
+        m_baseMinNormFreq = minNormFreq;
+        m_baseMaxNormFreq = maxNormFreq;
+        m_baseFreq.clear();
+
+        // a range from 0 gets its 0 Hz point and is log-spaced from the lowest frequency on
+        double lowFreq = minNormFreq;
+        if (minNormFreq <= 0.f)
+        {
+            m_baseFreq.push_back(0.f);
+            lowFreq = std::min(ADAPTIVE_LOWEST_NORM_FREQ, 0.5f*maxNormFreq);
+        }
+        int nrofpoints = ADAPTIVE_BASE_POINTS - static_cast<int>(m_baseFreq.size());
+        double factor = std::pow(maxNormFreq/lowFreq, 1.0/(nrofpoints - 1));
+        double freq = lowFreq;
+        for (auto kk = 0; kk < nrofpoints; ++kk, freq *= factor)
+            m_baseFreq.push_back(static_cast<float>(kk == nrofpoints - 1 ? maxNormFreq : freq));
+
+        m_baseCos.resize(m_baseFreq.size());
+        m_baseSin.resize(m_baseFreq.size());
+        for (auto kk = 0U; kk < m_baseFreq.size(); ++kk)
+        {
+            double angle = 2.0*3.14159265358979323846*m_baseFreq[kk];
+            m_baseCos[kk] = static_cast<float>(std::cos(angle));
+            m_baseSin[kk] = static_cast<float>(std::sin(angle));
+        }
+    };
+
+    void evaluate(const float* normFreq, const float* c, const float* s, int N,
+        const std::vector<std::complex<float>>& poles,
+        const std::vector<std::complex<float>>& zeros, float gain_dB,
+        std::vector<float>* results)
+    {
+        float* numRe = m_numRe.data();
+        float* numIm = m_numIm.data();
+        float* denRe = m_denRe.data();
+        float* denIm = m_denIm.data();
+        float* phaseSum = m_phaseSum.data();
+        float* delaySum = m_delaySum.data();
+
+        std::fill(numRe, numRe + N, 1.f);
+        std::fill(numIm, numIm + N, 0.f);
+        std::fill(denRe, denRe + N, 1.f);
+        std::fill(denIm, denIm + N, 0.f);
+        std::fill(phaseSum, phaseSum + N, 0.f);
+        std::fill(delaySum, delaySum + N, 0.f);
+
+        for (const auto& zero : zeros)
+            multiplyRoot(normFreq, c, s, numRe, numIm, phaseSum, delaySum, zero.real(), zero.imag(), 1.f, N);
+
+        for (const auto& pole : poles)
+            multiplyRoot(normFreq, c, s, denRe, denIm, phaseSum, delaySum, pole.real(), pole.imag(), -1.f, N);
+
+        // the phase at w = 0 is a multiple of pi (real filter), a polarity (pi) is not a delay
+        float phaseAtZero = 0.f;
+        for (const auto& zero : zeros)
+            phaseAtZero += rootPhaseAtZero(zero.real(), zero.imag());
+        for (const auto& pole : poles)
+            phaseAtZero -= rootPhaseAtZero(pole.real(), pole.imag());
+        phaseAtZero = g_fastPi*std::round(phaseAtZero/g_fastPi);
+
+        float* magnitude = results[magnitude_dB].data();
+        float* phase = results[phase_deg].data();
+        float* unwrapped = results[unwrappedPhase_deg].data();
+        float* group = results[groupDelay].data();
+        float* phasedelay = results[phaseDelay].data();
+        const float radToDeg = 180.f/g_fastPi;
+        for (auto kk = 0; kk < N; ++kk)
+        {
+            float numPower = numRe[kk]*numRe[kk] + numIm[kk]*numIm[kk];
+            float denPower = denRe[kk]*denRe[kk] + denIm[kk]*denIm[kk];
+            magnitude[kk] = gain_dB + fastPowerTodB(numPower) - fastPowerTodB(denPower);
+
+            phase[kk] = fastWrapAngle(phaseSum[kk])*radToDeg;
+            unwrapped[kk] = phaseSum[kk]*radToDeg;
+            group[kk] = delaySum[kk];
+            // -phi/w, the limit at w = 0 is the group delay
+            float omega = g_fastTwoPi*normFreq[kk];
+            phasedelay[kk] = omega > 0.f ? (phaseAtZero - phaseSum[kk])/omega : delaySum[kk];
+        }
+    };
+
+    // phase of (1 - root) with the same branch as in multiplyRoot
+    float rootPhaseAtZero(float rootRe, float rootIm)
+    {
+        float radius2 = rootRe*rootRe + rootIm*rootIm;
+        if (radius2 > 1.f)
+            return g_fastPi + std::atan2(rootIm, rootRe) + std::atan2(-rootIm, radius2 - rootRe);
+
+        return std::atan2(-rootIm, 1.f - rootRe);
+    };
+
+    /**
+     * prod *= (e^jw - root), the magnitude is the one of (1 - root e^-jw).
+     * Phase and delay of (1 - root e^-jw) are added with sign (+1 zero, -1 pole).
+     */
+    void multiplyRoot(const float* normFreq, const float* c, const float* s,
+        float* prodRe, float* prodIm, float* phaseSum, float* delaySum,
+        float rootRe, float rootIm, float sign, int N)
+    {
+        const float radius2 = rootRe*rootRe + rootIm*rootIm;
+        // outside the unit circle: arg(1 - q) = pi + arg(root) - w + arg(1 - 1/q), q = root e^-jw
+        const bool isOutside = radius2 > 1.f;
+        const float outsideOffset = g_fastPi + std::atan2(rootIm, rootRe);
+        for (auto kk = 0; kk < N; ++kk)
+        {
+            float re = c[kk] - rootRe;
+            float im = s[kk] - rootIm;
+            float newRe = prodRe[kk]*re - prodIm[kk]*im;
+            float newIm = prodRe[kk]*im + prodIm[kk]*re;
+            prodRe[kk] = newRe;
+            prodIm[kk] = newIm;
+
+            float qRe = rootRe*c[kk] + rootIm*s[kk];
+            float qIm = rootIm*c[kk] - rootRe*s[kk];
+            float distance2 = re*re + im*im + 1e-20f;
+            delaySum[kk] -= sign*(qRe - radius2)/distance2;
+
+            float arg = isOutside
+                ? outsideOffset - g_fastTwoPi*normFreq[kk] + fastAtan2(qIm, radius2 - qRe)
+                : fastAtan2(-qIm, 1.f - qRe);
+            phaseSum[kk] += sign*arg;
+        }
+    };
+};
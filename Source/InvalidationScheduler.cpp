@@ -0,0 +1,71 @@
+/*
+  ==============================================================================
+    InvalidationScheduler.cpp
+
+    Authors:    agent
+
+    SPDX-License-Identifier: BSD-3-Clause
+ ==============================================================================
+*/
+
+#include "InvalidationScheduler.h"
+
+InvalidationScheduler::InvalidationScheduler(Component& host)
+:m_host(host), m_dirtyFlags(0), m_frameCounter(0)
+{
+#if JUCE_MAJOR_VERSION >= 7
+    m_vblank = std::make_unique<VBlankAttachment>(&m_host, [this]() { serviceFrame(); });
+#else
+    startTimerHz(INVALIDATION_FALLBACK_RATE_HZ);
+#endif
+}
+
+InvalidationScheduler::~InvalidationScheduler()
+{
+    stopTimer();
+}
+
+int InvalidationScheduler::addClient(std::function<void()> refresh)
+{
+    jassert(m_clients.size() < INVALIDATION_MAX_CLIENTS);
+    m_clients.push_back(std::move(refresh));
+    return static_cast<int>(m_clients.size()) - 1;
+}
+
+void InvalidationScheduler::addFrameClient(std::function<void()> refresh, int everyNthFrame)
+{
+    m_frameClients.push_back({ std::move(refresh), jmax(1, everyNthFrame) });
+}
+
+void InvalidationScheduler::invalidate(int clientId)
+{
+    jassert(isPositiveAndBelow(clientId, INVALIDATION_MAX_CLIENTS));
+    m_dirtyFlags.fetch_or(1u << clientId);
+}
+
+void InvalidationScheduler::timerCallback()
+{
+    serviceFrame();
+}
+
+void InvalidationScheduler::serviceFrame()
+{
+    // the flags stay set while hidden, so the update follows when shown again
+    if (!m_host.isShowing())
+        return;
+
+    ++m_frameCounter;
+    uint32 dirty = m_dirtyFlags.exchange(0);
+    for (auto kk = 0U; kk < m_clients.size() && dirty != 0; ++kk)
+    {
+        if (dirty & (1u << kk))
+        {
+            dirty &= ~(1u << kk);
+            m_clients[kk]();
+        }
+    }
+
+    for (auto& client : m_frameClients)
+        if (m_frameCounter % static_cast<uint32>(client.everyNthFrame) == 0)
+            client.refresh();
+}
@@ -0,0 +1,64 @@
+/*
+  ==============================================================================
+    InvalidationScheduler.h
+
+    Collects the "something changed" notifications of the GUI and services
+    them once per display frame. Sources only set a dirty flag (any thread),
+    so a burst of parameter changes during a mouse drag ends in one update
+    per frame instead of one per event. Frame clients (meters) are polled
+    every n-th frame instead of running their own timers.
+
+    The frame source is the VBlankAttachment of the host (JUCE 7 and newer)
+    or a 60 Hz timer. Nothing is serviced while the host is not showing.
+
+    Authors:    agent
+
+    SPDX-License-Identifier: BSD-3-Clause
+ ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <vector>
+#include <JuceHeader.h>
+
+#define INVALIDATION_MAX_CLIENTS 32
+#define INVALIDATION_FALLBACK_RATE_HZ 60
+
+class InvalidationScheduler : private Timer
+{
+public:
+    InvalidationScheduler(Component& host);
+    ~InvalidationScheduler();
+
+    /** registers a refresh function (message thread), returns the id for invalidate() */
+    int addClient(std::function<void()> refresh);
+    /** refresh is called every everyNthFrame-th frame while the host is showing */
+    void addFrameClient(std::function<void()> refresh, int everyNthFrame = 1);
+
+    // marks the client as dirty, can be called from any thread and as often as needed
+    void invalidate(int clientId);
+
+private:
+    void timerCallback() override;
+    void serviceFrame();
+
+    Component& m_host;
+    std::vector<std::function<void()>> m_clients;
+    struct FrameClient
+    {
+        std::function<void()> refresh;
+        int everyNthFrame;
+    };
+    std::vector<FrameClient> m_frameClients;
+    std::atomic<uint32> m_dirtyFlags;
+    uint32 m_frameCounter;
+
+#if JUCE_MAJOR_VERSION >= 7
+    std::unique_ptr<VBlankAttachment> m_vblank;
+#endif
+
+    JUCE_DECLARE_NON_COPYABLE (InvalidationScheduler)
+};
@@ -13,9 +13,23 @@
 #define PRESETHANDLER_HEIGHT 30
 //==============================================================================
 MainComponent::MainComponent(AudioProcessorValueTreeState& vts, PresetHandler& ph, FilterDeMystifierAudioProcessor& p)
-    :m_vts(vts), m_processor(p), m_pnComponent(m_vts, p), m_presetGUI(ph), m_3DComponent(m_vts), 
-    m_bodeComponent(m_vts, BodeDiagramComponent::LayoutTypes::horizontal)
+    :m_vts(vts), m_processor(p), m_pnComponent(m_vts, p), m_presetGUI(ph), m_3DComponent(m_vts, p.getFilterModelStore()), 
+    m_bodeComponent(m_vts, p.getFilterModelStore(), BodeDiagramComponent::LayoutTypes::horizontal),
+    m_timeResponseComponent(p.getFilterModelStore()),
+    m_analysisWorker(p.getFilterModelStore()), m_scheduler(*this)
 {
+    m_analysisWorker.addTask(&m_bodeComponent);
+    m_analysisWorker.addTask(&m_3DComponent);
+    m_analysisWorker.addTask(&m_timeResponseComponent);
+    m_analysisWorker.start();
+    m_bodeComponent.needsUpdate = [this]() { m_analysisWorker.requestUpdate(); };
+
+    m_guiUpdateId = m_scheduler.addClient([this]() { refreshGUI(); });
+    // the meters were polled with 25 Hz by their own timers, every 2nd frame is close to that
+    m_scheduler.addFrameClient([this]() { m_pnComponent.updateMeters(); }, 2);
+    m_scheduler.addFrameClient([this]() { updateSpectrum(); });
+    m_bodeComponent.analyserToggled = [this](bool active) { m_processor.m_spectrumAnalyser.setActive(active); };
+
     setSize(m_minWidth, m_minHeight);
     ScopedLock sp();
     m_pnComponent.somethingChanged = [this]() { updateGUI(); };
@@ -26,6 +40,7 @@ MainComponent::MainComponent(AudioProcessorValueTreeState& vts, PresetHandler& p
     addAndMakeVisible(m_pnComponent);
     addAndMakeVisible(m_3DComponent);
     addAndMakeVisible(m_bodeComponent);
+    addAndMakeVisible(m_timeResponseComponent);
 
     addAndMakeVisible(m_aboutBox);
     deactivateAboutBox();
@@ -37,6 +52,9 @@ MainComponent::MainComponent(AudioProcessorValueTreeState& vts, PresetHandler& p
 MainComponent::~MainComponent()
 {
     // This shuts down the GL system and stops the rendering calls.
+    m_analysisWorker.stopThread(2000);
+    // nobody looks at the spectrum without the editor
+    m_processor.m_spectrumAnalyser.setActive(false);
 }
 
 //==============================================================================
@@ -65,19 +83,35 @@ void MainComponent::resized()
     auto topBounds = bounds.removeFromTop(PRESETHANDLER_HEIGHT);
     m_presetGUI.setBounds(topBounds);
     m_pnComponent.setBounds(bounds.removeFromLeft(0.4 * bounds.getWidth()));
-    m_bodeComponent.setBounds(bounds.removeFromBottom(0.3 * bounds.getHeight()));
+    auto bottomBounds = bounds.removeFromBottom(0.3 * bounds.getHeight());
+    m_timeResponseComponent.setBounds(bottomBounds.removeFromRight(bottomBounds.getWidth() / 3));
+    m_bodeComponent.setBounds(bottomBounds);
     m_3DComponent.setBounds(bounds);
 
     m_aboutBox.setBounds(getLocalBounds());
 }
 
 void MainComponent::updateGUI()
+{
+    // only marks the GUI as dirty, all changes within one frame are handled once
+    m_scheduler.invalidate(m_guiUpdateId);
+}
+
+void MainComponent::refreshGUI()
 {
     m_presetGUI.setSomethingChanged(); 
-    m_bodeComponent.updatePlot();
+    // Bode and 3D data are computed in the background, fast drags are merged there
+    m_analysisWorker.requestUpdate();
     m_pnComponent.updatePlot();
-    m_3DComponent.setSomethingChanged();
-    repaint();
+    // the Bode and 3D views repaint themselves when their new data is published
+    m_pnComponent.repaint();
+}
+
+void MainComponent::updateSpectrum()
+{
+    auto& analyser = m_processor.m_spectrumAnalyser;
+    if (analyser.isActive() && analyser.getSpectrum(m_spectrum))
+        m_bodeComponent.setSpectrum(m_spectrum);
 }
 
 void MainComponent::activateAboutBox()
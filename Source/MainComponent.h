@@ -29,7 +29,10 @@
 #include "PresetHandler.h" 
 #include "PNComponent.h"
 #include "TransferFun3DComponent.h"
+#include "TimeResponseComponent.h"
 #include "PluginProcessor.h"
+#include "AnalysisWorker.h"
+#include "InvalidationScheduler.h"
 
 //==============================================================================
 /*
@@ -48,7 +51,12 @@ public:
     void resized() override;
     
     //==========================================================================
-    void setSamplingRate(double fs) { m_bodeComponent.setSamplingRate(fs); }
+    void setSamplingRate(double fs) 
+    { 
+        m_bodeComponent.setSamplingRate(fs); 
+        m_timeResponseComponent.setSamplingRate(fs);
+        m_analysisWorker.requestUpdate();
+    }
 
 private:
     //==========================================================================
@@ -62,6 +70,16 @@ private:
     PNComponent m_pnComponent;
     TransferFun3DComponent m_3DComponent;
     BodeDiagramComponent m_bodeComponent;
+    TimeResponseComponent m_timeResponseComponent;
+
+    // declared after the views, so it is stopped before they are deleted
+    AnalysisWorker m_analysisWorker;
+    // all GUI updates go through here, at most once per display frame
+    InvalidationScheduler m_scheduler;
+    int m_guiUpdateId;
+
+    // latest analyser result from the processor, polled once per frame while the analyser is on
+    SpectrumAnalyser::Spectrum m_spectrum;
 
     Slider m_b0Slider;
     std::unique_ptr<SliderAttachment> m_b0Attachment;
@@ -72,6 +90,8 @@ private:
     float m_minWidth = m_minHeight * 16 / 9;
 
     void updateGUI();
+    void refreshGUI();
+    void updateSpectrum();
     
     void activateAboutBox();
     void deactivateAboutBox();
@@ -0,0 +1,203 @@
+/*
+  ==============================================================================
+    ModulationMatrix.cpp
+
+    Authors:    agent
+
+    SPDX-License-Identifier: BSD-3-Clause
+ ==============================================================================
+*/
+
+#include "ModulationMatrix.h"
+#include "FastMath.h"
+
+int ModulationParameter::addParameter(std::vector<std::unique_ptr<RangedAudioParameter>>& paramVector)
+{
+	for (auto kk = 0U; kk < MAX_LFO_INSTANCES; ++kk)
+	{
+		paramVector.push_back(std::make_unique<AudioParameterFloat>(paramLFORate.ID[kk],
+			paramLFORate.name + " " + std::to_string(kk + 1),
+			NormalisableRange<float>(paramLFORate.minValue, paramLFORate.maxValue, 0.f, 0.3f),
+			paramLFORate.defaultValue,
+			paramLFORate.unitName,
+			AudioProcessorParameter::genericParameter,
+			[](float value, int MaxLen) {return String(value, 2).substring(0, MaxLen);},
+			[](const String& text) {return text.getFloatValue();}));
+
+		paramVector.push_back(std::make_unique<AudioParameterChoice>(paramLFOShape.ID[kk],
+			paramLFOShape.name + " " + std::to_string(kk + 1),
+			paramLFOShape.choices,
+			paramLFOShape.defaultValue));
+	}
+	paramVector.push_back(std::make_unique<AudioParameterFloat>(paramEnvAttack.ID,
+		paramEnvAttack.name,
+		NormalisableRange<float>(paramEnvAttack.minValue, paramEnvAttack.maxValue, 0.f, 0.3f),
+		paramEnvAttack.defaultValue,
+		paramEnvAttack.unitName,
+		AudioProcessorParameter::genericParameter,
+		[](float value, int MaxLen) {return String(value, 1).substring(0, MaxLen);},
+		[](const String& text) {return text.getFloatValue();}));
+
+	paramVector.push_back(std::make_unique<AudioParameterFloat>(paramEnvRelease.ID,
+		paramEnvRelease.name,
+		NormalisableRange<float>(paramEnvRelease.minValue, paramEnvRelease.maxValue, 0.f, 0.3f),
+		paramEnvRelease.defaultValue,
+		paramEnvRelease.unitName,
+		AudioProcessorParameter::genericParameter,
+		[](float value, int MaxLen) {return String(value, 1).substring(0, MaxLen);},
+		[](const String& text) {return text.getFloatValue();}));
+
+	paramVector.push_back(std::make_unique<AudioParameterFloat>(paramSeqRate.ID,
+		paramSeqRate.name,
+		NormalisableRange<float>(paramSeqRate.minValue, paramSeqRate.maxValue, 0.f, 0.5f),
+		paramSeqRate.defaultValue,
+		paramSeqRate.unitName,
+		AudioProcessorParameter::genericParameter,
+		[](float value, int MaxLen) {return String(value, 2).substring(0, MaxLen);},
+		[](const String& text) {return text.getFloatValue();}));
+
+	for (auto kk = 0U; kk < MAX_SEQ_STEPS; ++kk)
+	{
+		paramVector.push_back(std::make_unique<AudioParameterFloat>(paramSeqStep.ID[kk],
+			paramSeqStep.name + " " + std::to_string(kk + 1),
+			NormalisableRange<float>(paramSeqStep.minValue, paramSeqStep.maxValue, VALUE_STEP),
+			paramSeqStep.defaultValue,
+			paramSeqStep.unitName,
+			AudioProcessorParameter::genericParameter,
+			[](float value, int MaxLen) {return String(value, 2).substring(0, MaxLen);},
+			[](const String& text) {return text.getFloatValue();}));
+	}
+
+	for (auto kk = 0U; kk < MAX_MOD_SLOTS; ++kk)
+	{
+		paramVector.push_back(std::make_unique<AudioParameterChoice>(paramModSource.ID[kk],
+			paramModSource.name + " " + std::to_string(kk + 1),
+			paramModSource.choices,
+			paramModSource.defaultValue));
+
+		paramVector.push_back(std::make_unique<AudioParameterChoice>(paramModTarget.ID[kk],
+			paramModTarget.name + " " + std::to_string(kk + 1),
+			paramModTarget.choices,
+			paramModTarget.defaultValue));
+
+		paramVector.push_back(std::make_unique<AudioParameterFloat>(paramModDepth.ID[kk],
+			paramModDepth.name + " " + std::to_string(kk + 1),
+			NormalisableRange<float>(paramModDepth.minValue, paramModDepth.maxValue, VALUE_STEP),
+			paramModDepth.defaultValue,
+			paramModDepth.unitName,
+			AudioProcessorParameter::genericParameter,
+			[](float value, int MaxLen) {return String(value, 2).substring(0, MaxLen);},
+			[](const String& text) {return text.getFloatValue();}));
+	}
+	return 1;
+}
+
+ModulationMatrix::ModulationMatrix()
+:m_fs(48000.0),m_isActive(false)
+{
+    reset();
+}
+
+void ModulationMatrix::prepareParameter(std::unique_ptr<AudioProcessorValueTreeState>& vts)
+{
+    for (auto kk = 0; kk < MAX_LFO_INSTANCES; ++kk)
+    {
+        m_lfoRate[kk] = vts->getRawParameterValue(paramLFORate.ID[kk]);
+        m_lfoShape[kk] = vts->getRawParameterValue(paramLFOShape.ID[kk]);
+    }
+    m_envAttack = vts->getRawParameterValue(paramEnvAttack.ID);
+    m_envRelease = vts->getRawParameterValue(paramEnvRelease.ID);
+    m_seqRate = vts->getRawParameterValue(paramSeqRate.ID);
+    for (auto kk = 0; kk < MAX_SEQ_STEPS; ++kk)
+        m_seqStep[kk] = vts->getRawParameterValue(paramSeqStep.ID[kk]);
+
+    for (auto kk = 0; kk < MAX_MOD_SLOTS; ++kk)
+    {
+        m_modSource[kk] = vts->getRawParameterValue(paramModSource.ID[kk]);
+        m_modTarget[kk] = vts->getRawParameterValue(paramModTarget.ID[kk]);
+        m_modDepth[kk] = vts->getRawParameterValue(paramModDepth.ID[kk]);
+    }
+}
+
+void ModulationMatrix::prepareToPlay(double sampleRate)
+{
+    m_fs = sampleRate;
+    reset();
+}
+
+void ModulationMatrix::reset()
+{
+    for (auto kk = 0; kk < MAX_LFO_INSTANCES; ++kk)
+        m_lfoPhase[kk] = 0.f;
+    m_envelope = 0.f;
+    m_seqPhase = 0.f;
+    std::fill(std::begin(m_sourceValue), std::end(m_sourceValue), 0.f);
+    std::fill(std::begin(m_targetOffset), std::end(m_targetOffset), 0.f);
+}
+
+float ModulationMatrix::computeLFO(float phase, Shape shape)
+{
+    switch (shape)
+    {
+    case Shape::Sine:
+        return fastSin(g_fastTwoPi*phase);
+    case Shape::Triangle:
+        return 1.f - 4.f*std::abs(phase - 0.5f);
+    case Shape::Saw:
+        return 2.f*phase - 1.f;
+    case Shape::Square:
+        return phase < 0.5f ? 1.f : -1.f;
+    default:
+        return 0.f;
+    }
+}
+
+void ModulationMatrix::processControlPoint(const juce::AudioBuffer<float>& input, int startSample, int nrofsamples)
+{
+    std::fill(std::begin(m_targetOffset), std::end(m_targetOffset), 0.f);
+    m_isActive = false;
+    for (auto kk = 0; kk < MAX_MOD_SLOTS; ++kk)
+    {
+        if (int(*m_modSource[kk] + 0.5f) != int(Source::Off) && *m_modDepth[kk] != 0.f)
+            m_isActive = true;
+    }
+    float timeStep = static_cast<float>(nrofsamples/m_fs);
+
+    // LFOs
+    for (auto kk = 0; kk < MAX_LFO_INSTANCES; ++kk)
+    {
+        m_lfoPhase[kk] += *m_lfoRate[kk]*timeStep;
+        m_lfoPhase[kk] -= std::floor(m_lfoPhase[kk]);
+    }
+    // sequencer
+    m_seqPhase += *m_seqRate*timeStep;
+    m_seqPhase -= MAX_SEQ_STEPS*std::floor(m_seqPhase/MAX_SEQ_STEPS);
+
+    // nothing routed, keep the sources running but skip the rest
+    if (!m_isActive)
+        return;
+
+    // envelope follower: peak of this sub block over all channels
+    float peak = 0.f;
+    for (auto cc = 0; cc < input.getNumChannels(); ++cc)
+    {
+        auto range = FloatVectorOperations::findMinAndMax(input.getReadPointer(cc, startSample), nrofsamples);
+        peak = jmax(peak, std::abs(range.getStart()), std::abs(range.getEnd()));
+    }
+    float tau_ms = peak > m_envelope ? *m_envAttack : *m_envRelease;
+    float alpha = std::exp(-1000.f*timeStep/tau_ms);
+    m_envelope = alpha*m_envelope + (1.f - alpha)*peak;
+
+    m_sourceValue[int(Source::Off)] = 0.f;
+    for (auto kk = 0; kk < MAX_LFO_INSTANCES; ++kk)
+        m_sourceValue[int(Source::LFO1) + kk] = computeLFO(m_lfoPhase[kk], static_cast<Shape>(int(*m_lfoShape[kk] + 0.5f)));
+    m_sourceValue[int(Source::Envelope)] = jmin(m_envelope, 1.f);
+    m_sourceValue[int(Source::Sequencer)] = *m_seqStep[jlimit(0, MAX_SEQ_STEPS - 1, int(m_seqPhase))];
+
+    for (auto kk = 0; kk < MAX_MOD_SLOTS; ++kk)
+    {
+        int source = jlimit(0, int(Source::Sequencer), int(*m_modSource[kk] + 0.5f));
+        int target = jlimit(0, NUM_MOD_TARGETS - 1, int(*m_modTarget[kk] + 0.5f));
+        m_targetOffset[target] += *m_modDepth[kk]*m_sourceValue[source];
+    }
+}
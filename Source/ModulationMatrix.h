@@ -0,0 +1,200 @@
+/*
+  ==============================================================================
+    ModulationMatrix.h
+
+    Internal modulation of the pole and zero positions. Two LFOs, an envelope
+    follower of the input and a step sequencer can be routed by a small matrix
+    to the radius and the angle of every pole and zero and to the gain.
+    The matrix is evaluated once per control point of the processor.
+
+    Authors:    agent
+
+    SPDX-License-Identifier: BSD-3-Clause
+ ==============================================================================
+*/
+
+#pragma once
+
+#include <vector>
+#include <JuceHeader.h>
+#include "PNParameter.h"
+
+#define MAX_LFO_INSTANCES 2
+#define MAX_SEQ_STEPS 8
+#define MAX_MOD_SLOTS 4
+
+// modulation targets: gain first, then radius/angle of pole and zero of every section
+#define MOD_TARGETS_PER_SECTION 4
+#define NUM_MOD_TARGETS (1 + MOD_TARGETS_PER_SECTION*MAX_POLE_INSTANCES)
+
+// full depth moves the radius by +-0.5, the angle by +-pi and the gain by +-24 dB
+#define MOD_RADIUS_RANGE 0.5f
+#define MOD_ANGLE_RANGE 3.14159265358979323846f
+#define MOD_GAIN_RANGE_DB 24.f
+
+const struct
+{
+	const std::string ID[MAX_LFO_INSTANCES] = { "LFO1Rate", "LFO2Rate" };
+	std::string name = "LFO rate";
+	std::string unitName = " Hz";
+	float minValue = 0.01f;
+	float maxValue = 20.f;
+	float defaultValue = 1.f;
+}paramLFORate;
+
+const struct
+{
+	const std::string ID[MAX_LFO_INSTANCES] = { "LFO1Shape", "LFO2Shape" };
+	std::string name = "LFO shape";
+	const juce::StringArray choices = { "Sine", "Triangle", "Saw", "Square" };
+	int defaultValue = 0;
+}paramLFOShape;
+
+const struct
+{
+	const std::string ID = "EnvAttack";
+	std::string name = "Envelope attack";
+	std::string unitName = " ms";
+	float minValue = 1.f;
+	float maxValue = 500.f;
+	float defaultValue = 10.f;
+}paramEnvAttack;
+
+const struct
+{
+	const std::string ID = "EnvRelease";
+	std::string name = "Envelope release";
+	std::string unitName = " ms";
+	float minValue = 10.f;
+	float maxValue = 2000.f;
+	float defaultValue = 200.f;
+}paramEnvRelease;
+
+const struct
+{
+	const std::string ID = "SeqRate";
+	std::string name = "Sequencer rate";
+	std::string unitName = " steps/s";
+	float minValue = 0.1f;
+	float maxValue = 20.f;
+	float defaultValue = 2.f;
+}paramSeqRate;
+
+const struct
+{
+	const std::string ID[MAX_SEQ_STEPS] = { "SeqStep1", "SeqStep2", "SeqStep3", "SeqStep4",
+											"SeqStep5", "SeqStep6", "SeqStep7", "SeqStep8" };
+	std::string name = "Sequencer step";
+	std::string unitName = "";
+	float minValue = -1.f;
+	float maxValue = 1.f;
+	float defaultValue = 0.f;
+}paramSeqStep;
+
+const struct
+{
+	const std::string ID[MAX_MOD_SLOTS] = { "Mod1Source", "Mod2Source", "Mod3Source", "Mod4Source" };
+	std::string name = "Modulation source";
+	const juce::StringArray choices = { "Off", "LFO 1", "LFO 2", "Envelope", "Sequencer" };
+	int defaultValue = 0;
+}paramModSource;
+
+const struct
+{
+	const std::string ID[MAX_MOD_SLOTS] = { "Mod1Target", "Mod2Target", "Mod3Target", "Mod4Target" };
+	std::string name = "Modulation target";
+	const juce::StringArray choices = { "Gain",
+		"Pole 1 radius", "Pole 1 angle", "Zero 1 radius", "Zero 1 angle",
+		"Pole 2 radius", "Pole 2 angle", "Zero 2 radius", "Zero 2 angle",
+		"Pole 3 radius", "Pole 3 angle", "Zero 3 radius", "Zero 3 angle",
+		"Pole 4 radius", "Pole 4 angle", "Zero 4 radius", "Zero 4 angle" };
+	int defaultValue = 1;
+}paramModTarget;
+
+const struct
+{
+	const std::string ID[MAX_MOD_SLOTS] = { "Mod1Depth", "Mod2Depth", "Mod3Depth", "Mod4Depth" };
+	std::string name = "Modulation depth";
+	std::string unitName = "";
+	float minValue = -1.f;
+	float maxValue = 1.f;
+	float defaultValue = 0.f;
+}paramModDepth;
+
+class ModulationParameter
+{
+public:
+	int addParameter(std::vector<std::unique_ptr<RangedAudioParameter>>& paramVector);
+};
+
+class ModulationMatrix
+{
+public:
+    enum class Source
+    {
+        Off,
+        LFO1,
+        LFO2,
+        Envelope,
+        Sequencer
+    };
+    enum class Shape
+    {
+        Sine,
+        Triangle,
+        Saw,
+        Square
+    };
+    enum TargetType
+    {
+        poleRadius = 0,
+        poleAngle,
+        zeroRadius,
+        zeroAngle
+    };
+
+    ModulationMatrix();
+    void prepareParameter(std::unique_ptr<AudioProcessorValueTreeState>& vts);
+    void prepareToPlay(double sampleRate);
+    void reset();
+
+    /**
+     * advances all sources by nrofsamples and computes the target offsets.
+     * The envelope follower uses the (unfiltered) input of this sub block.
+     */
+    void processControlPoint(const juce::AudioBuffer<float>& input, int startSample, int nrofsamples);
+
+    // true if at least one slot routes a source with depth != 0
+    bool isActive() const { return m_isActive; };
+
+    float getGainOffset_dB() const { return m_targetOffset[0]*MOD_GAIN_RANGE_DB; };
+    float getRadiusOffset(int section, bool pole) const
+    { return m_targetOffset[getTargetIndex(section, pole ? poleRadius : zeroRadius)]*MOD_RADIUS_RANGE; };
+    float getAngleOffset(int section, bool pole) const
+    { return m_targetOffset[getTargetIndex(section, pole ? poleAngle : zeroAngle)]*MOD_ANGLE_RANGE; };
+
+    static int getTargetIndex(int section, TargetType type) { return 1 + MOD_TARGETS_PER_SECTION*section + type; };
+
+private:
+    double m_fs;
+
+    float m_lfoPhase[MAX_LFO_INSTANCES];
+    float m_envelope;
+    float m_seqPhase;
+
+    float m_sourceValue[int(Source::Sequencer) + 1];
+    float m_targetOffset[NUM_MOD_TARGETS];
+    bool m_isActive;
+
+    std::atomic<float>* m_lfoRate[MAX_LFO_INSTANCES];
+    std::atomic<float>* m_lfoShape[MAX_LFO_INSTANCES];
+    std::atomic<float>* m_envAttack;
+    std::atomic<float>* m_envRelease;
+    std::atomic<float>* m_seqRate;
+    std::atomic<float>* m_seqStep[MAX_SEQ_STEPS];
+    std::atomic<float>* m_modSource[MAX_MOD_SLOTS];
+    std::atomic<float>* m_modTarget[MAX_MOD_SLOTS];
+    std::atomic<float>* m_modDepth[MAX_MOD_SLOTS];
+
+    float computeLFO(float phase, Shape shape);
+};
@@ -61,7 +61,7 @@
 
 *******************************************************************************/
 
-#include "WavefrontObjFile.h"
+#include "SurfaceMesh.h"
 #include <juce_opengl/juce_opengl.h>
 #include <math.h>
 //==============================================================================
@@ -77,15 +77,17 @@ class OpenGLAppClass : public juce::OpenGLAppComponent
 {
 public:
     
-    std::vector<std::vector<float>>& m_pointsMatrix;
+    SurfaceGrid& m_pointsMatrix;
+    SurfaceRootData& m_rootData;
     //==============================================================================
     Draggable3DOrientation m_draggableOrientation;
     float m_scale = 0.5;
 
     std::function<void()> logoPressed;
 
-    OpenGLAppClass(float minZ, float maxZ, std::vector<std::vector<float>>& pointsMatrix)
-        : m_maxValueZ(maxZ), m_minValueZ(minZ), m_pointsMatrix(pointsMatrix)
+    OpenGLAppClass(float minZ, float maxZ, SurfaceGrid& pointsMatrix, SurfaceRootData& rootData)
+        : m_pointsMatrix(pointsMatrix), m_rootData(rootData), m_somethingChanged(false),
+        m_minValueZ(minZ), m_maxValueZ(maxZ), m_shaderSurfaceAvailable(false)
     {
 
         m_refreshButton.setButtonText("center");
@@ -94,8 +96,10 @@ public:
 
         setOpaque(true);
 
-        // Tell the context to repaint on a loop.
-        openGLContext.setContinuousRepainting(true);
+        // Frames are only rendered on request (model change, interaction,
+        // resize), the swap interval paces them to the display refresh.
+        openGLContext.setContinuousRepainting(false);
+        openGLContext.setSwapInterval(1);
 
         // Finally - we attach the context to this Component.
         openGLContext.attachTo(*this);
@@ -118,23 +122,55 @@ public:
 
     void shutdown() override
     {
+        m_shaderSurfaceAvailable = false;
+        for (auto& mesh : m_meshes)
+            mesh.release(openGLContext);
         shader    .reset();
-        shape     .reset();
-        attributes.reset();
         uniforms  .reset();
+        m_surfaceShader.reset();
+        m_surfaceUniforms.reset();
     }
 
     void refreshView()
     {
         m_viewMatrix= getViewMatrix();
+        requestFrame();
     }
 
 
     void setSomethingChanged()
     {
         m_somethingChanged = true;
+        requestFrame();
     }
 
+    /**
+     * renders one new frame, if the component is on screen (message thread).
+     * Hidden or minimised, nothing is rendered; the pending change is drawn
+     * when the component is shown again.
+     */
+    void requestFrame()
+    {
+        if (isShowing())
+            openGLContext.triggerRepaint();
+    }
+
+    void visibilityChanged() override
+    {
+        requestFrame();
+    }
+
+    void parentHierarchyChanged() override
+    {
+        requestFrame();
+    }
+
+    /**
+     * true if the vertex shader evaluates |H(z)| from the root data, then
+     * the heights do not have to be computed on the CPU (any thread)
+     */
+    bool isShaderSurfaceAvailable() const { return m_shaderSurfaceAvailable; };
+
     juce::Matrix3D<float> getProjectionMatrix() const
     {
         auto w = 1.0f / (0.5f +m_scale+ 0.1f);                                          // [1]
@@ -222,6 +258,7 @@ public:
         }
             
         m_viewMatrix= addAngletoViewMatrix(addY,  -addX);
+        requestFrame();
     }
 
     void mouseWheelMove(const MouseEvent&, const MouseWheelDetails& d) override
@@ -229,13 +266,13 @@ public:
          m_scale = m_scale + d.deltaY;
          if (m_scale <= -0.6)
              m_scale = -0.5;
+         requestFrame();
     }
 
     
 
     void render() override
     {
-        juce::Thread::sleep( 40 );
         jassert (juce::OpenGLHelpers::isContextActive());
 
         auto desktopScale = (float) openGLContext.getRenderingScale();          // [1]
@@ -264,23 +301,44 @@ glEnable(GL_DEPTH_TEST);
                     juce::roundToInt (desktopScale * (float) getWidth()),
                     juce::roundToInt (desktopScale * (float) getHeight()));     // [4]
 
-        shader->use();                                                          // [5]
-
-        if (uniforms->projectionMatrix.get() != nullptr)                        // [6]
-            uniforms->projectionMatrix->setMatrix4 (getProjectionMatrix().mat, 1, false);
-
-        if (uniforms->viewMatrix.get() != nullptr)                              // [7]
-            uniforms->viewMatrix->setMatrix4 (m_viewMatrix.mat, 1, false);
-        
         if (m_somethingChanged)
         {
             m_somethingChanged = false;
             if (updateData != nullptr)
                 updateData();
-            shape.reset(new Shape(openGLContext, m_pointsMatrix));
+            // only heights and colours are streamed to the existing buffers
+            if (m_surfaceShader == nullptr)
+                getMesh(m_pointsMatrix.getNumRows(), m_pointsMatrix.getNumColumns())
+                    .update(openGLContext, m_pointsMatrix);
+        }
+
+        // a pole or zero move is only a uniform update, the grid is static
+        bool useSurfaceShader = m_surfaceShader != nullptr;
+        if (!useSurfaceShader && shader == nullptr)
+            return;
+
+        auto& program = useSurfaceShader ? *m_surfaceShader : *shader;
+        auto& programUniforms = useSurfaceShader ? *m_surfaceUniforms : *uniforms;
+        program.use();                                                          // [5]
+
+        if (programUniforms.projectionMatrix.get() != nullptr)                  // [6]
+            programUniforms.projectionMatrix->setMatrix4 (getProjectionMatrix().mat, 1, false);
+
+        if (programUniforms.viewMatrix.get() != nullptr)                        // [7]
+            programUniforms.viewMatrix->setMatrix4 (m_viewMatrix.mat, 1, false);
+
+        if (useSurfaceShader)
+        {
+            programUniforms.setRootData(m_rootData, m_minValueZ, m_maxValueZ);
+            auto& mesh = getMesh(m_rootData.gridSize, m_rootData.gridSize);
+            mesh.prepare(openGLContext, m_rootData.gridSize, m_rootData.gridSize);
+            mesh.draw(openGLContext, m_surfaceAttributes);                      // [8]
+        }
+        else
+        {
+            getMesh(m_pointsMatrix.getNumRows(), m_pointsMatrix.getNumColumns())
+                .draw(openGLContext, m_attributes);
         }
-        
-        shape->draw (openGLContext, *attributes);                               // [8]
 
         // Reset the element buffers so child Components draw correctly
         openGLContext.extensions.glBindBuffer (GL_ARRAY_BUFFER, 0);             // [9]
@@ -377,36 +435,35 @@ glEnable(GL_DEPTH_TEST);
         m_refreshButton.setBounds(bounds);
 
         m_draggableOrientation.setViewport(getLocalBounds());
+        requestFrame();
     }
 
     void createShaders()
     {
+        // grid position (0...1) from a static buffer, height and colour are streamed
         vertexShader = R"(
-            attribute vec4 position;
-            attribute vec4 sourceColour;
-            attribute vec4 textureCoordIn;
+            attribute vec2 gridPosition;
+            attribute float height;
+            attribute vec4 heightColour;
 
             uniform mat4 projectionMatrix;
             uniform mat4 viewMatrix;
 
             varying vec4 destinationColour;
-            varying vec4 textureCoordOut;
 
             void main()
             {
-                destinationColour = sourceColour;
-                textureCoordOut = textureCoordIn;
+                destinationColour = heightColour;
+                vec4 position = vec4(2.0 * (gridPosition - 0.5), 2.0 * (height - 0.5), 1.0);
                 gl_Position = projectionMatrix * viewMatrix * position;
             })";
 
         fragmentShader =
            #if JUCE_OPENGL_ES
-            R"(varying lowp vec4 destinationColour;
-               varying lowp vec2 textureCoordOut;)"
+            R"(varying lowp vec4 destinationColour;)"
            #else
 
-            R"(varying vec4 destinationColour;
-               varying vec4 textureCoordOut;)"
+            R"(varying vec4 destinationColour;)"
            #endif
             R"(
                void main()
@@ -414,7 +471,7 @@ glEnable(GL_DEPTH_TEST);
            #if JUCE_OPENGL_ES
             R"(    lowp vec4 colour = vec4(0.95, 0.57, 0.03, 0.7);)"
            #else
-            R"(    vec4 colour = textureCoordOut;)"
+            R"(    vec4 colour = destinationColour;)"
            #endif
             R"(    gl_FragColor = colour;
                })";
@@ -426,15 +483,14 @@ glEnable(GL_DEPTH_TEST);
               && newShader->addFragmentShader (juce::OpenGLHelpers::translateFragmentShaderToV3 (fragmentShader))
               && newShader->link())
         {
-            shape     .reset();
-            attributes.reset();
             uniforms  .reset();
 
             shader.reset (newShader.release());                                                                 // [3]
             shader->use();
             
-            shape     .reset (new Shape (openGLContext, m_pointsMatrix));
-            attributes.reset (new Attributes (openGLContext, *shader));
+            m_attributes = SurfaceMesh::getAttributes(openGLContext, *shader);
+            getMesh(m_pointsMatrix.getNumRows(), m_pointsMatrix.getNumColumns())
+                .update(openGLContext, m_pointsMatrix);
             uniforms  .reset (new Uniforms (openGLContext, *shader));
 
             statusText = "GLSL: v" + juce::String (juce::OpenGLShaderProgram::getLanguageVersion(), 2);
@@ -443,93 +499,167 @@ glEnable(GL_DEPTH_TEST);
         {
             statusText = newShader->getLastError();                                                             // [4]
         }
-    }
 
-    std::function<void()> updateData;
+        createSurfaceShader();
+    }
 
-private:
+    /**
+     * vertex shader that evaluates |H(z)| and the colour per grid point from
+     * uniforms. Plain GLSL 1.10 (no loops over uniform arrays), so it also runs
+     * on software renderers like llvmpipe. If it does not compile, the heights
+     * from the CPU are used.
+     */
+    void createSurfaceShader()
+    {
+        m_surfaceShader.reset();
+        m_surfaceUniforms.reset();
+        m_shaderSurfaceAvailable = false;
 
-    Matrix3D<float> m_viewMatrix = getViewMatrix();
-    float m_angleX, m_angleY;
-    int m_dragx,m_dragy;
-    bool m_somethingChanged;
-    float m_minValueZ;
-    float m_maxValueZ;
-    float m_valueStepZ;
+        ColourGradient gradient = SurfaceMesh::getGradient();
+        auto toVec4 = [&gradient](double position)
+        {
+            Colour c = gradient.getColourAtPosition(position);
+            return "vec4(" + String(c.getFloatRed()) + ", " + String(c.getFloatGreen()) + ", "
+                + String(c.getFloatBlue()) + ", 1.0)";
+        };
+        const float gridStep = 0.5f;
+        const float nrofGridlines = jmax(paramPoleReal.maxValue - paramPoleReal.minValue,
+            paramPoleImag.maxValue - paramPoleImag.minValue) / gridStep;
+        const float radius = 0.5f / jmax(paramPoleReal.maxValue, paramPoleImag.maxValue);
 
-    Image m_JadeLogo;
+        String surfaceVertexShader = R"(
+            attribute vec2 gridPosition;
 
-    TextButton m_refreshButton;
+            uniform mat4 projectionMatrix;
+            uniform mat4 viewMatrix;
 
-    //==============================================================================
-    struct Vertex
-    {
-        float position[3];
-        float normal[3];
-        float colour[4];
-        float texCoord[4];
-    };
+            // xy: root, z: on, w: conjugated
+            uniform vec4 zero0;
+            uniform vec4 zero1;
+            uniform vec4 zero2;
+            uniform vec4 zero3;
+            uniform vec4 pole0;
+            uniform vec4 pole1;
+            uniform vec4 pole2;
+            uniform vec4 pole3;
+            uniform vec2 planeMin;
+            uniform vec2 planeSize;
+            uniform float gain_dB;
+            uniform float gainScale;
+            uniform float minValue;
+            uniform float maxValue;
 
-    //==============================================================================
-    // This class just manages the attributes that the shaders use.
-    struct Attributes
-    {
-        Attributes (juce::OpenGLContext& context, juce::OpenGLShaderProgram& shaderProgram)
-        {
-            position      .reset (createAttribute (context, shaderProgram, "position"));
-            normal        .reset (createAttribute (context, shaderProgram, "normal"));
-            sourceColour  .reset (createAttribute (context, shaderProgram, "sourceColour"));
-            textureCoordIn.reset (createAttribute (context, shaderProgram, "textureCoordIn"));
-        }
+            varying vec4 destinationColour;
 
-        void enable (juce::OpenGLContext& context)
-        {
-            if (position.get() != nullptr)
+            // 10 log10(|z-r|^2 |z-r*|^2) of an active root (pair)
+            float rootLevel(vec2 z, vec4 root)
             {
-                context.extensions.glVertexAttribPointer (position->attributeID, 3, GL_FLOAT, GL_FALSE, sizeof (Vertex), nullptr);
-                context.extensions.glEnableVertexAttribArray (position->attributeID);
+                vec2 d = z - root.xy;
+                vec2 dConj = z - vec2(root.x, -root.y);
+                float power = dot(d, d) * mix(1.0, dot(dConj, dConj), root.w);
+                return root.z * 4.342944819 * log(max(power, 1.0e-20));
             }
 
-            if (normal.get() != nullptr)
+            // pulls the normalised grid point towards an active root (pair), monotonic
+            // for strength < 1, so more vertices end up close to the singularities
+            vec2 warpToRoot(vec2 p, vec4 root)
             {
-                context.extensions.glVertexAttribPointer (normal->attributeID, 3, GL_FLOAT, GL_FALSE, sizeof (Vertex), (GLvoid*) (sizeof (float) * 3));
-                context.extensions.glEnableVertexAttribArray (normal->attributeID);
+                vec2 d = p - (root.xy - planeMin) / planeSize;
+                float s = length(d) / )" + String(SURFACE_WARP_ROOT_WIDTH, 4) + R"(;
+                p -= root.z * )" + String(SURFACE_WARP_STRENGTH, 4) + R"( * exp(-s * s) * d;
+                vec2 dConj = p - (vec2(root.x, -root.y) - planeMin) / planeSize;
+                float sConj = length(dConj) / )" + String(SURFACE_WARP_ROOT_WIDTH, 4) + R"(;
+                return p - root.z * root.w * )" + String(SURFACE_WARP_STRENGTH, 4) + R"( * exp(-sConj * sConj) * dConj;
             }
 
-            if (sourceColour.get() != nullptr)
+            vec4 levelColour(float h)
             {
-                context.extensions.glVertexAttribPointer (sourceColour->attributeID, 4, GL_FLOAT, GL_FALSE, sizeof (Vertex), (GLvoid*) (sizeof (float) * 6));
-                context.extensions.glEnableVertexAttribArray (sourceColour->attributeID);
+                float x = clamp(h, 0.0, 1.0);
+                vec4 c = mix()" + toVec4(0.0) + ", " + toVec4(0.3) + R"(, clamp(x / 0.3, 0.0, 1.0));
+                c = mix(c, )" + toVec4(0.5) + R"(, clamp((x - 0.3) / 0.2, 0.0, 1.0));
+                c = mix(c, )" + toVec4(0.7) + R"(, clamp((x - 0.5) / 0.2, 0.0, 1.0));
+                c = mix(c, )" + toVec4(1.0) + R"(, clamp((x - 0.7) / 0.3, 0.0, 1.0));
+                return c;
             }
 
-            if (textureCoordIn.get() != nullptr)
+            void main()
+            {
+                // the static grid is already denser around the unit circle
+                vec2 p = warpToRoot(gridPosition, zero0);
+                p = warpToRoot(p, zero1);
+                p = warpToRoot(p, zero2);
+                p = warpToRoot(p, zero3);
+                p = warpToRoot(p, pole0);
+                p = warpToRoot(p, pole1);
+                p = warpToRoot(p, pole2);
+                p = clamp(warpToRoot(p, pole3), 0.0, 1.0);
+
+                vec2 z = planeMin + p * planeSize;
+                float level = rootLevel(z, zero0) + rootLevel(z, zero1)
+                    + rootLevel(z, zero2) + rootLevel(z, zero3)
+                    - rootLevel(z, pole0) - rootLevel(z, pole1)
+                    - rootLevel(z, pole2) - rootLevel(z, pole3);
+                float height = (gainScale * (level + gain_dB) - minValue) / (maxValue - minValue);
+
+                // gridlines and unit circle
+                float nrofGridlines = )" + String(nrofGridlines, 1) + R"(;
+                vec2 gridDistance = abs(p * nrofGridlines - floor(p * nrofGridlines + 0.5)) / nrofGridlines;
+                float circleDistance = abs(length(p - 0.5) - )" + String(radius, 6) + R"();
+                float onLine = min(gridDistance.x, min(gridDistance.y, circleDistance)) < 0.004 ? 1.0 : 0.0;
+                destinationColour = mix(levelColour(height), vec4(0.0, 0.0, 0.0, 1.0), onLine);
+
+                vec4 position = vec4(2.0 * (p - 0.5), 2.0 * (height - 0.5), 1.0);
+                gl_Position = projectionMatrix * viewMatrix * position;
+            })";
+
+        std::unique_ptr<juce::OpenGLShaderProgram> newShader (new juce::OpenGLShaderProgram (openGLContext));
+        if (newShader->addVertexShader (juce::OpenGLHelpers::translateVertexShaderToV3 (surfaceVertexShader))
+              && newShader->addFragmentShader (juce::OpenGLHelpers::translateFragmentShaderToV3 (fragmentShader))
+              && newShader->link())
+        {
+            m_surfaceShader.reset (newShader.release());
+            m_surfaceShader->use();
+            m_surfaceAttributes = SurfaceMesh::getAttributes(openGLContext, *m_surfaceShader);
+            m_surfaceUniforms.reset (new Uniforms (openGLContext, *m_surfaceShader));
+            m_shaderSurfaceAvailable = m_surfaceAttributes.position >= 0;
+            if (!m_shaderSurfaceAvailable)
             {
-                context.extensions.glVertexAttribPointer (textureCoordIn->attributeID, 4, GL_FLOAT, GL_FALSE, sizeof (Vertex), (GLvoid*) (sizeof (float) * 10));
-                context.extensions.glEnableVertexAttribArray (textureCoordIn->attributeID);
+                m_surfaceShader.reset();
+                m_surfaceUniforms.reset();
             }
         }
+    }
+
+    std::function<void()> updateData;
+
+private:
 
-        void disable (juce::OpenGLContext& context)
+    // the mesh with this size, otherwise the one not used last is recreated
+    SurfaceMesh& getMesh(int rows, int columns)
+    {
+        for (auto kk = 0; kk < 2; ++kk)
         {
-            if (position.get() != nullptr)       context.extensions.glDisableVertexAttribArray (position->attributeID);
-            if (normal.get() != nullptr)         context.extensions.glDisableVertexAttribArray (normal->attributeID);
-            if (sourceColour.get() != nullptr)   context.extensions.glDisableVertexAttribArray (sourceColour->attributeID);
-            if (textureCoordIn.get() != nullptr) context.extensions.glDisableVertexAttribArray (textureCoordIn->attributeID);
+            if (m_meshes[kk].getNumRows() == rows && m_meshes[kk].getNumColumns() == columns)
+            {
+                m_lastMesh = kk;
+                return m_meshes[kk];
+            }
         }
+        m_lastMesh = 1 - m_lastMesh;
+        return m_meshes[m_lastMesh];
+    }
 
-        std::unique_ptr<juce::OpenGLShaderProgram::Attribute> position, normal, sourceColour, textureCoordIn;
+    Matrix3D<float> m_viewMatrix = getViewMatrix();
+    float m_angleX, m_angleY;
+    int m_dragx,m_dragy;
+    std::atomic<bool> m_somethingChanged;
+    float m_minValueZ;
+    float m_maxValueZ;
+    float m_valueStepZ;
 
-    private:
-        static juce::OpenGLShaderProgram::Attribute* createAttribute (juce::OpenGLContext& context,
-                                                                      juce::OpenGLShaderProgram& shader,
-                                                                      const juce::String& attributeName)
-        {
-            if (context.extensions.glGetAttribLocation (shader.getProgramID(), attributeName.toRawUTF8()) < 0)
-                return nullptr;
+    Image m_JadeLogo;
 
-            return new juce::OpenGLShaderProgram::Attribute (shader, attributeName.toRawUTF8());
-        }
-    };
+    TextButton m_refreshButton;
 
     //==============================================================================
     // This class just manages the uniform values that the demo shaders use.
@@ -539,123 +669,52 @@ private:
         {
             projectionMatrix.reset (createUniform (context, shaderProgram, "projectionMatrix"));
             viewMatrix      .reset (createUniform (context, shaderProgram, "viewMatrix"));
-        }
-
-        std::unique_ptr<juce::OpenGLShaderProgram::Uniform> projectionMatrix, viewMatrix;
-
-    private:
-        static juce::OpenGLShaderProgram::Uniform* createUniform (juce::OpenGLContext& context,
-                                                                  juce::OpenGLShaderProgram& shaderProgram,
-                                                                  const juce::String& uniformName)
-        {
-            if (context.extensions.glGetUniformLocation (shaderProgram.getProgramID(), uniformName.toRawUTF8()) < 0)
-                return nullptr;
-
-            return new juce::OpenGLShaderProgram::Uniform (shaderProgram, uniformName.toRawUTF8());
-        }
-    };
-
-    //==============================================================================
-    /** This loads a 3D model from an OBJ file and converts it into some vertex buffers
-        that we can draw.
-    */
-    struct Shape
-    {
-        Shape(juce::OpenGLContext& context)
-        {
-            auto dir = juce::File::getCurrentWorkingDirectory();
 
-            int numTries = 0;
-
-            while (!dir.getChildFile("Resources").exists() && numTries++ < 15)
-                dir = dir.getParentDirectory();
-
-            if (shapeFile.load(dir.getChildFile("Resources").getChildFile("TransferFun3DShape.txt")).wasOk())
-                for (auto* s : shapeFile.shapes)
-                    vertexBuffers.add(new VertexBuffer(context, *s));
-        }
-        Shape(juce::OpenGLContext& context, std::vector<std::vector<float>>& values)
-        {
-            if (shapeFile.load(values).wasOk())
-                for (auto* s : shapeFile.shapes)
-                    vertexBuffers.add(new VertexBuffer(context, *s));
-        }
-
-        void draw(juce::OpenGLContext& context, Attributes& glAttributes)
-        {
-            for (auto* vertexBuffer : vertexBuffers)
+            for (auto kk = 0; kk < MAX_POLE_INSTANCES; ++kk)
             {
-                vertexBuffer->bind();
-                glAttributes.enable(context);
-                glDrawElements(GL_TRIANGLES, vertexBuffer->numIndices, GL_UNSIGNED_INT, nullptr);
-                glAttributes.disable(context);
+                zeros[kk].reset (createUniform (context, shaderProgram, "zero" + String(kk)));
+                poles[kk].reset (createUniform (context, shaderProgram, "pole" + String(kk)));
             }
+            planeMin .reset (createUniform (context, shaderProgram, "planeMin"));
+            planeSize.reset (createUniform (context, shaderProgram, "planeSize"));
+            gain_dB  .reset (createUniform (context, shaderProgram, "gain_dB"));
+            gainScale.reset (createUniform (context, shaderProgram, "gainScale"));
+            minValueZ.reset (createUniform (context, shaderProgram, "minValue"));
+            maxValueZ.reset (createUniform (context, shaderProgram, "maxValue"));
         }
 
+        std::unique_ptr<juce::OpenGLShaderProgram::Uniform> projectionMatrix, viewMatrix;
 
-    private:
-        struct VertexBuffer
+        // only used by the surface shader
+        void setRootData(const SurfaceRootData& data, float minValue, float maxValue)
         {
-            VertexBuffer (juce::OpenGLContext& context, WavefrontObjFile::Shape& aShape) : openGLContext (context)
+            for (auto kk = 0; kk < MAX_POLE_INSTANCES; ++kk)
             {
-                numIndices = aShape.mesh.indices.size();                                    // [1]
-
-                openGLContext.extensions.glGenBuffers (1, &vertexBuffer);                   // [2]
-                openGLContext.extensions.glBindBuffer (GL_ARRAY_BUFFER, vertexBuffer);
-
-                juce::Array<Vertex> vertices;
-                createVertexListFromMesh(aShape.mesh, vertices, juce::Colour::fromFloatRGBA(1.f,1.f,1.f,1.f));     // [3]
-
-                openGLContext.extensions.glBufferData (GL_ARRAY_BUFFER,                     // [4]
-                                                       static_cast<GLsizeiptr> (static_cast<size_t> (vertices.size()) * sizeof (Vertex)),
-                                                       vertices.getRawDataPointer(), GL_STATIC_DRAW);
-
-                openGLContext.extensions.glGenBuffers (1, &indexBuffer);                    // [5]
-                openGLContext.extensions.glBindBuffer (GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
-                openGLContext.extensions.glBufferData (GL_ELEMENT_ARRAY_BUFFER,
-                                                       static_cast<GLsizeiptr> (static_cast<size_t> (numIndices) * sizeof (juce::uint32)),
-                                                       aShape.mesh.indices.getRawDataPointer(), GL_STATIC_DRAW);
+                if (zeros[kk] != nullptr)
+                    zeros[kk]->set(data.zeros[kk][0], data.zeros[kk][1], data.zeros[kk][2], data.zeros[kk][3]);
+                if (poles[kk] != nullptr)
+                    poles[kk]->set(data.poles[kk][0], data.poles[kk][1], data.poles[kk][2], data.poles[kk][3]);
             }
+            if (planeMin != nullptr)    planeMin->set(data.planeMin[0], data.planeMin[1]);
+            if (planeSize != nullptr)   planeSize->set(data.planeSize[0], data.planeSize[1]);
+            if (gain_dB != nullptr)     gain_dB->set(data.gain_dB);
+            if (gainScale != nullptr)   gainScale->set(data.gainScale);
+            if (minValueZ != nullptr)   minValueZ->set(minValue);
+            if (maxValueZ != nullptr)   maxValueZ->set(maxValue);
+        }
 
-            ~VertexBuffer()
-            {
-                openGLContext.extensions.glDeleteBuffers (1, &vertexBuffer);
-                openGLContext.extensions.glDeleteBuffers (1, &indexBuffer);
-            }
-
-            void bind()
-            {
-                openGLContext.extensions.glBindBuffer (GL_ARRAY_BUFFER, vertexBuffer);
-                openGLContext.extensions.glBindBuffer (GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
-            }
-
-            GLuint vertexBuffer, indexBuffer;
-            int numIndices;
-            juce::OpenGLContext& openGLContext;
-
-            JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VertexBuffer)
-        };
-
-        WavefrontObjFile shapeFile;
-        juce::OwnedArray<VertexBuffer> vertexBuffers;
+        std::unique_ptr<juce::OpenGLShaderProgram::Uniform> zeros[MAX_POLE_INSTANCES], poles[MAX_POLE_INSTANCES];
+        std::unique_ptr<juce::OpenGLShaderProgram::Uniform> planeMin, planeSize, gain_dB, gainScale, minValueZ, maxValueZ;
 
-        static void createVertexListFromMesh (const WavefrontObjFile::Mesh& mesh, juce::Array<Vertex>& list, juce::Colour colour)
+    private:
+        static juce::OpenGLShaderProgram::Uniform* createUniform (juce::OpenGLContext& context,
+                                                                  juce::OpenGLShaderProgram& shaderProgram,
+                                                                  const juce::String& uniformName)
         {
+            if (context.extensions.glGetUniformLocation (shaderProgram.getProgramID(), uniformName.toRawUTF8()) < 0)
+                return nullptr;
 
-            auto scale = 2.0f;                                              // [6]
-            WavefrontObjFile::TextureCoord defaultTexCoord { 0.5f, 0.5f, 0.5f, 1.0f};
-            WavefrontObjFile::Vertex defaultNormal { 0.5f, 0.5f, 0.5f };
-            for (auto i = 0; i < mesh.vertices.size(); ++i)                     // [7]
-            {
-                const auto& v = mesh.vertices.getReference (i);
-                const auto& n = i < mesh.normals.size() ? mesh.normals.getReference (i) : defaultNormal;
-                const auto& tc = i < mesh.textureCoords.size() ? mesh.textureCoords.getReference (i) : defaultTexCoord;
-
-                list.add ({ { scale * (v.x-0.5f), scale * (v.y-0.5f), scale * (v.z-0.5f), },
-                            { scale * n.x, scale * n.y, scale * n.z, },
-                            { colour.getFloatRed(), colour.getFloatGreen(), colour.getFloatBlue(), colour.getFloatAlpha() },
-                            { tc.a, tc.b, tc.c,tc.d } });                                  // [8]
-            }
+            return new juce::OpenGLShaderProgram::Uniform (shaderProgram, uniformName.toRawUTF8());
         }
     };
 
@@ -663,9 +722,17 @@ private:
     juce::String fragmentShader;
 
     std::unique_ptr<juce::OpenGLShaderProgram> shader;
-    std::unique_ptr<Shape> shape;
-    std::unique_ptr<Attributes> attributes;
+    // coarse (while dragging) and full resolution, both stay on the GPU
+    SurfaceMesh m_meshes[2];
+    int m_lastMesh = 0;
+    SurfaceMesh::Attributes m_attributes;
     std::unique_ptr<Uniforms> uniforms;
 
+    // shader evaluation of the surface (nullptr: CPU heights are used)
+    std::unique_ptr<juce::OpenGLShaderProgram> m_surfaceShader;
+    SurfaceMesh::Attributes m_surfaceAttributes;
+    std::unique_ptr<Uniforms> m_surfaceUniforms;
+    std::atomic<bool> m_shaderSurfaceAvailable;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OpenGLAppClass)
 };
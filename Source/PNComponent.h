@@ -35,7 +35,7 @@ class PNComponent    : public Component
 {
 public:
     PNComponent(AudioProcessorValueTreeState& vts, FilterDeMystifierAudioProcessor& p)
-        : m_processor(p), m_vts(vts), m_pnPlot(vts), m_meter(p.m_meter), m_protectionGUI(vts)
+        : m_processor(p), m_vts(vts), m_pnPlot(vts, p.getFilterModelStore()), m_meter(p.m_meter), m_limiterHistory(vts, p.getLimiter()), m_protectionGUI(vts)
 
     {
         // add items to the combo-box
@@ -55,7 +55,12 @@ public:
                 PNcontrolComponent::PNType::pole));
             m_poleControls[kk]->somethingChanged = [this]() {if (somethingChanged != nullptr) somethingChanged();};
             addAndMakeVisible(m_poleControls[kk]);
+
+            // level after the section of this pole
+            m_sectionMeters.add(std::make_unique<SectionMeterComponent>(p.m_sectionMeter, kk));
+            addAndMakeVisible(m_sectionMeters[kk]);
         }
+        m_processor.m_sectionMeter.setActive(true);
         for (auto kk = 0; kk < m_numOfZero; ++kk)
         {
             m_zeroControls.add(std::make_unique<PNcontrolComponent>(m_vts, kk,
@@ -69,6 +74,7 @@ public:
         addAndMakeVisible(m_pnPlot);
 
         addAndMakeVisible(m_meter);
+        addAndMakeVisible(m_limiterHistory);
 
         addAndMakeVisible(m_protectionGUI);
         m_protectionGUI.protectPoles = [this]() {protectPoles();};
@@ -84,6 +90,7 @@ public:
 
     ~PNComponent()
     {
+        m_processor.m_sectionMeter.setActive(false);
     }
 
     void paint (Graphics& g) override
@@ -95,6 +102,8 @@ public:
     }
 
     #define POLE_ZERO_CTRL_SPACE 10
+    #define SECTION_METER_WIDTH 60
+    #define LIMITER_HISTORY_HEIGHT 40
     void resized() override
     {
         auto bounds = getLocalBounds();
@@ -103,6 +112,7 @@ public:
         m_protectionGUI.setBounds(protectionBounds);
 
         auto pnPlotBounds = bounds.removeFromTop(bounds.getHeight() * PLOT_HEIGHT_REL);
+        m_limiterHistory.setBounds(pnPlotBounds.removeFromBottom(LIMITER_HISTORY_HEIGHT).reduced(PADDING, 0));
         auto meterBounds = pnPlotBounds.removeFromRight(0.15*pnPlotBounds.getWidth()).reduced(10);
         m_meter.setBounds(meterBounds);
         m_pnPlot.setBounds(pnPlotBounds);
@@ -119,8 +129,13 @@ public:
         controlBounds.reduce(PADDING, PADDING / 2);
         int controlHeight = (controlBounds.getHeight() - 2 * POLE_ZERO_CTRL_SPACE) / (m_numOfZero + m_numOfPole);
         if (controlHeight > 40) controlHeight = 40;
+        // the same width for pole and zero rows
+        auto sectionMeterBounds = controlBounds.removeFromRight(SECTION_METER_WIDTH);
         for (auto kk = 0U; kk < m_poleControls.size(); ++kk)
+        {
             m_poleControls[kk]->setBounds(controlBounds.removeFromTop(controlHeight));
+            m_sectionMeters[kk]->setBounds(sectionMeterBounds.removeFromTop(controlHeight).reduced(2, controlHeight / 4));
+        }
         controlBounds.removeFromTop(POLE_ZERO_CTRL_SPACE);
         for (auto kk = 0U; kk < m_zeroControls.size(); ++kk)
             m_zeroControls[kk]->setBounds(controlBounds.removeFromTop(controlHeight));
@@ -147,9 +162,11 @@ public:
             if(2 * kk < m_filterOrder){
                 m_poleControls[kk]->setAcivation(true);
                 m_poleControls[kk]->setVisible(true);
+                m_sectionMeters[kk]->setVisible(true);
             }else{
                 m_poleControls[kk]->setAcivation(false);
                 m_poleControls[kk]->setVisible(false);
+                m_sectionMeters[kk]->setVisible(false);
             }
 
             if(2 * kk+1 < m_filterOrder){
@@ -189,6 +206,15 @@ public:
         }
     }
 
+    void updateMeters()
+    {
+        m_meter.updateFromMeter();
+        m_limiterHistory.updateFromLimiter();
+        for (auto* sectionMeter : m_sectionMeters)
+            if (sectionMeter->isVisible())
+                sectionMeter->updateFromMeter();
+    }
+
     void updatePNComponent()
     {
         int filterOrder = getFilterOrderFromParams();
@@ -204,6 +230,8 @@ private:
     
     FilterDeMystifierAudioProcessor& m_processor;
     SimpleMeterComponent m_meter;
+    // when and how hard the safety limiter worked
+    BrickwallLimiterComponent<float> m_limiterHistory;
 
     PNParameter m_PNparam;
     int m_numOfPole = m_PNparam.maxNrOfPole;
@@ -233,6 +261,8 @@ private:
     // Pole Zero control widgets
     OwnedArray<PNcontrolComponent> m_poleControls;
     OwnedArray<PNcontrolComponent> m_zeroControls;
+    // one per pole row (section)
+    OwnedArray<SectionMeterComponent> m_sectionMeters;
 
 
     void updateSliderValue()
@@ -23,8 +23,8 @@
 #define INDEX_SIZE 10
 
 //==============================================================================
-PNplot::PNplot(AudioProcessorValueTreeState& vts)
-    : ScaledPlot(false), m_vts(vts), m_isSelected(false),
+PNplot::PNplot(AudioProcessorValueTreeState& vts, FilterModelStore& modelStore)
+    : ScaledPlot(false), m_vts(vts), m_modelStore(modelStore), m_isSelected(false),
     m_graphCenterX(0), m_graphCenterY(0), m_graphWidthHeight(0)
 {
     m_axisLabelX = String("Real Part");
@@ -49,12 +49,16 @@ PNplot::~PNplot()
 
 void PNplot::paint(Graphics& g)
 {   
+    paintStaticLayerCached(g);
+    paintPolesAndZeros(g);
+}
+
+void PNplot::paintStaticLayer(Graphics& g)
+{
     g.setColour(PlotBackgroundColour);
 
     g.fillRect(m_startPosX, m_startPosY, m_endPosX-m_startPosX, m_endPosY-m_startPosY);
 
-    m_graphCenterX = scaleToCoordsX(0.0);
-    m_graphCenterY = scaleToCoordsY(0.0);
     // AXIS 
     paintAxis(g);
 
@@ -65,8 +69,6 @@ void PNplot::paint(Graphics& g)
 
     g.drawEllipse(m_graphCenterX - unitCircleRadius, m_graphCenterY - unitCircleRadius,
         unitCicleDiameter, unitCicleDiameter, LINEWIDH_MEDIUM);
-
-    paintPolesAndZeros(g);
 }
 
 void PNplot::resized()
@@ -86,6 +88,8 @@ void PNplot::resized()
         m_startPosY += difference / 2;
         m_endPosY -= difference / 2;
     }
+    m_graphCenterX = scaleToCoordsX(0.0);
+    m_graphCenterY = scaleToCoordsY(0.0);
 }
 
 void PNplot::mouseDown(const MouseEvent& event)
@@ -135,14 +139,14 @@ void PNplot::getSelectedObjectFromCoords(int x, int y)
     m_selectedObject["p"] = -1;
     m_selectedObject["z"] = -1;
 
-    for (int kk = 0; kk < m_numOfPole; ++kk)
+    auto model = m_modelStore.getModel();
+    for (int kk = 0; kk < MAX_POLE_INSTANCES; ++kk)
     {
-        if (m_vts.getParameter(paramPoleBool.ID[kk])->getValue())
+        const FilterModel::Section& section = model->sections[kk];
+        if (section.poleOn)
         {
-            float real = *(m_vts.getRawParameterValue(paramPoleReal.ID[kk]));
-            float imag = *(m_vts.getRawParameterValue(paramPoleImag.ID[kk]));
-            int xVal = scaleToCoordsX(real);
-            int yVal = scaleToCoordsY(imag);
+            int xVal = scaleToCoordsX(section.pole.real());
+            int yVal = scaleToCoordsY(section.pole.imag());
             if (x < xVal + POLE_DIAMETER / 2 && x > xVal - POLE_DIAMETER / 2 &&
                 y < yVal + POLE_DIAMETER / 2 && y > yVal - POLE_DIAMETER / 2)
             {
@@ -151,14 +155,13 @@ void PNplot::getSelectedObjectFromCoords(int x, int y)
             }
         }
     }
-    for (int kk = 0; kk < m_numOfPole; ++kk)
+    for (int kk = 0; kk < MAX_ZERO_INSTANCES; ++kk)
     {
-        if (m_vts.getParameter(paramZeroBool.ID[kk])->getValue())
+        const FilterModel::Section& section = model->sections[kk];
+        if (section.zeroOn)
         {
-            float real = *(m_vts.getRawParameterValue(paramZeroReal.ID[kk]));
-            float imag = *(m_vts.getRawParameterValue(paramZeroImag.ID[kk]));
-            int xVal = scaleToCoordsX(real);
-            int yVal = scaleToCoordsY(imag);
+            int xVal = scaleToCoordsX(section.zero.real());
+            int yVal = scaleToCoordsY(section.zero.imag());
             if (x < xVal + POLE_DIAMETER / 2 && x > xVal - POLE_DIAMETER / 2 &&
                 y < yVal + POLE_DIAMETER / 2 && y > yVal - POLE_DIAMETER / 2)
             {
@@ -264,46 +267,25 @@ void PNplot::paintAxis(Graphics& g)
 }
 
 /// <summary>
-/// Updating the data by getting the pole and zero from the vts and transfer 
-/// them into a vector of unique values and a vector of numbers the same values
-/// are given. Those member vectors are used to plot the pole zero diagram.
+/// Updating the data by getting the poles and zeros from the shared filter 
+/// model and transfer them into a vector of unique values and a vector of 
+/// numbers the same values are given. Those member vectors are used to plot 
+/// the pole zero diagram. Nothing is done if the model version is unchanged.
 /// </summary>
 void PNplot::updatePolesAndZeros()
 {
-    std::vector<std::complex<float>> poles;
-    std::vector<std::complex<float>> zeros;
+    auto model = m_modelStore.getModel();
+    if (m_model != nullptr && model->version == m_model->version)
+        return;
+
+    m_model = model;
     m_poles.clear();
     m_zeros.clear();
     m_polesCount.clear();
     m_zerosCount.clear();
 
-    for (auto kk = 0; kk < m_numOfPole; ++kk)
-    {
-        if (m_vts.getParameter(paramPoleBool.ID[kk])->getValue())
-        {
-            float real = *(m_vts.getRawParameterValue(paramPoleReal.ID[kk]));
-            float imag = *(m_vts.getRawParameterValue(paramPoleImag.ID[kk]));
-            poles.push_back(std::complex<float>(real, imag));
-
-            if(m_vts.getParameter(paramPoleConjugated.ID[kk])->getValue())
-                poles.push_back(std::complex<float>(real, -imag));
-        }
-    }
-    for (auto kk = 0; kk < m_numOfPole; ++kk)
-    {
-        if (m_vts.getParameter(paramZeroBool.ID[kk])->getValue())
-        {
-            float real = *(m_vts.getRawParameterValue(paramZeroReal.ID[kk]));
-            float imag = *(m_vts.getRawParameterValue(paramZeroImag.ID[kk]));
-            zeros.push_back(std::complex<float>(real, imag));
-            
-            if(m_vts.getParameter(paramZeroConjugated.ID[kk])->getValue())
-                zeros.push_back(std::complex<float>(real, -imag));
-        }
-    }
-
-    countSameValues(poles, m_poles, m_polesCount);
-    countSameValues(zeros, m_zeros, m_zerosCount);
+    countSameValues(model->poles, m_poles, m_polesCount);
+    countSameValues(model->zeros, m_zeros, m_zerosCount);
 }
 
 /// <summary>
@@ -316,7 +298,7 @@ void PNplot::updatePolesAndZeros()
 /// saved in. (std::vector<std::complex<float>>&) </param>
 /// <param name="counts"> Reference to a vector representing the number of times
 /// the values of the unique vector are included in the input vector. </param>
-void PNplot::countSameValues(std::vector<std::complex<float>>& valuesToCount, 
+void PNplot::countSameValues(const std::vector<std::complex<float>>& valuesToCount, 
     std::vector<std::complex<float>>& uniqueValues, std::vector<int>& counts)
 {
     for (auto kk = 0U; kk < valuesToCount.size(); ++kk)
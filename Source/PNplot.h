@@ -49,6 +49,7 @@
 #include "PNParameter.h"
 #include "PNcontrolComponent.h"
 #include "ScaledPlot.h"
+#include "FilterModel.h"
 
 //==============================================================================
 /*
@@ -57,7 +58,7 @@ using namespace std::complex_literals;
 class PNplot : public ScaledPlot 
 {
 public:
-    PNplot(AudioProcessorValueTreeState&);
+    PNplot(AudioProcessorValueTreeState&, FilterModelStore&);
     ~PNplot();
 
     void paint(Graphics&) override;
@@ -76,10 +77,8 @@ public:
 private:
 
     AudioProcessorValueTreeState& m_vts;
-
-    PNParameter m_PNparam;
-    int m_numOfPole = m_PNparam.maxNrOfPole;
-    int m_numOfZero = m_PNparam.maxNrOfZero;
+    FilterModelStore& m_modelStore;
+    std::shared_ptr<const FilterModel> m_model;
 
     std::vector<std::complex<float>> m_poles;
     std::vector<std::complex<float>> m_zeros;
@@ -111,9 +110,10 @@ private:
     void paintPole(Graphics& g, float real, float imaginary, int index);
 
     void paintAxis(Graphics& g);
+    void paintStaticLayer(Graphics& g) override;
     
     void updatePolesAndZeros();
-    void countSameValues(std::vector<std::complex<float>>& valuesToCount,
+    void countSameValues(const std::vector<std::complex<float>>& valuesToCount,
         std::vector<std::complex<float>>& uniqueValues, std::vector<int>& counts);
 
     void updateObjectValue(std::unordered_map<String, int> object, int x, int y);
@@ -13,6 +13,7 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 #include "PNParameter.h"
+#include "FastMath.h"
 
 //==============================================================================
 FilterDeMystifierAudioProcessor::FilterDeMystifierAudioProcessor()
@@ -33,6 +34,8 @@ FilterDeMystifierAudioProcessor::FilterDeMystifierAudioProcessor()
     // m_oldrate = *m_rate;
 
     m_PNparams.addParameter(m_paramVector);
+    m_modParams.addParameter(m_paramVector);
+    m_voiceParams.addParameter(m_paramVector);
 
     // Build VTS and PresetHandler
     m_paramVTS = std::make_unique<AudioProcessorValueTreeState>(*this,
@@ -55,8 +58,43 @@ FilterDeMystifierAudioProcessor::FilterDeMystifierAudioProcessor()
     for (unsigned int kk = 0; kk < m_nrofinputchannels ;++kk)
     {
         m_filter[kk].resize(m_nrofSOS); // we will have 4 SOS filter per channel
+        for (auto& sos : m_filter[kk])
+            sos.setClipValue(SOS_CLIP_VALUE);
     }
 
+    for (int sossec = 0; sossec < m_nrofSOS; ++sossec)
+    {
+        m_sosParams[sossec].poleOn = m_paramVTS->getRawParameterValue(paramPoleBool.ID[sossec]);
+        m_sosParams[sossec].poleConj = m_paramVTS->getRawParameterValue(paramPoleConjugated.ID[sossec]);
+        m_sosParams[sossec].poleReal = m_paramVTS->getRawParameterValue(paramPoleReal.ID[sossec]);
+        m_sosParams[sossec].poleImag = m_paramVTS->getRawParameterValue(paramPoleImag.ID[sossec]);
+        m_sosParams[sossec].zeroOn = m_paramVTS->getRawParameterValue(paramZeroBool.ID[sossec]);
+        m_sosParams[sossec].zeroConj = m_paramVTS->getRawParameterValue(paramZeroConjugated.ID[sossec]);
+        m_sosParams[sossec].zeroReal = m_paramVTS->getRawParameterValue(paramZeroReal.ID[sossec]);
+        m_sosParams[sossec].zeroImag = m_paramVTS->getRawParameterValue(paramZeroImag.ID[sossec]);
+        m_lastCoeffs[sossec] = {1.f, 0.f, 0.f, 0.f, 0.f};
+    }
+    m_gain = m_paramVTS->getRawParameterValue(paramb0.ID);
+    m_poleProtect = m_paramVTS->getRawParameterValue(paramPoleProtectBool.ID);
+    m_limiterOn = m_paramVTS->getRawParameterValue(paramLimiterBool.ID);
+    m_filterModel.attach(*m_paramVTS);
+    m_lastModelVersion = 0;
+    m_lastCoeffsModulated = false;
+    m_lastPoleProtect = true;
+    m_rampPosition = 1.f;
+    m_rampActive = false;
+    m_rampValid = false;
+    m_modulation.prepareParameter(m_paramVTS);
+    m_voices.prepareParameter(m_paramVTS);
+    m_voicesActive = false;
+    m_sectionClipping = false;
+    m_sectionTapsActive = false;
+
+    m_controlRateSamples = CONTROL_RATE_SAMPLES;
+    m_nrofControlPoints = 0;
+    m_maxWorkerThreads = -1;
+    m_processBuffer = nullptr;
+    m_healthEvents = 0;
 }
 
 
@@ -138,18 +176,33 @@ void FilterDeMystifierAudioProcessor::prepareToPlay (double sampleRate, int samp
 
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
-    m_data.resize(samplesPerBlock);
+    m_controlPoints.resize(samplesPerBlock/m_controlRateSamples + 1);
+    // the first block starts without a ramp
+    m_rampValid = false;
     m_limiter.prepareToPlay(sampleRate,nrofchannels);
 
     m_limiter.setReleaseTime(2000.f);
+    m_modulation.prepareToPlay(sampleRate);
+    m_voices.prepareToPlay(sampleRate, static_cast<int>(m_controlPoints.size()), m_nrofinputchannels);
     m_meter.prepareToPlay(sampleRate,samplesPerBlock);
-
+    // the measured transfer function compensates the look-ahead of the limiter
+    m_spectrumAnalyser.prepareToPlay(sampleRate, samplesPerBlock, m_limiter.getLatencySamples());
+    m_sectionMeter.prepareToPlay(sampleRate, m_nrofinputchannels);
+
+    // worker threads only pay off for many channels (e.g. higher order ambisonics)
+    int nrofworkers = 0;
+    if (nrofchannels >= PARALLEL_MIN_CHANNELS)
+        nrofworkers = jmin(SystemStats::getNumCpus() - 1, nrofchannels/PARALLEL_MIN_CHANNELS);
+    if (m_maxWorkerThreads >= 0)
+        nrofworkers = jmin(nrofworkers, m_maxWorkerThreads);
+    m_workerPool.start(jmax(0, nrofworkers));
 }
 
 void FilterDeMystifierAudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
+    m_workerPool.stop();
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -160,9 +213,10 @@ bool FilterDeMystifierAudioProcessor::isBusesLayoutSupported (const BusesLayout&
     return true;
   #else
     // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    if (layouts.getMainOutputChannelSet() != AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != AudioChannelSet::stereo())
+    // Every channel is filtered independently, so any layout up to
+    // m_nrofinputchannels works (e.g. ambisonics).
+    int nrofchannels = layouts.getMainOutputChannelSet().size();
+    if (nrofchannels < 1 || nrofchannels > m_nrofinputchannels)
         return false;
 
     // This checks if the input layout matches the output layout
@@ -179,92 +233,335 @@ bool FilterDeMystifierAudioProcessor::isBusesLayoutSupported (const BusesLayout&
 }
 #endif
 
-void FilterDeMystifierAudioProcessor::processBlock (AudioBuffer<float>& buffer, MidiBuffer& midiMessages)
+/**
+ * Reads the root coordinates and the gain once per block as the targets of
+ * the ramp. The ramp starts at the targets of the last block, so a jump of a
+ * parameter (automation, GUI) is spread over the control points of the block.
+ */
+void FilterDeMystifierAudioProcessor::startParameterRamp()
 {
-    bool poleProtect = m_paramVTS->getParameter(paramPoleProtectBool.ID)->getValue();
-    for (unsigned int sossec = 0 ; sossec < m_nrofSOS ; ++sossec )
+    m_rampActive = false;
+    for (int sossec = 0 ; sossec < m_nrofSOS ; ++sossec )
     {
-        float b0 = 1.0,b1 = 0.0,b2 = 0.0,a1 = 0.0,a2 = 0.0;
-        // Poles first
-        auto poleOn = m_paramVTS->getRawParameterValue(paramPoleBool.ID[sossec]);
-        float isPoleOn = *poleOn;
-        auto poleWithConj = m_paramVTS->getRawParameterValue(paramPoleConjugated.ID[sossec]);
-        float isPoleConj = *poleWithConj;
-
-        auto poleReal = m_paramVTS->getRawParameterValue(paramPoleReal.ID[sossec]);
-        float realvalpole = *poleReal;
-        auto poleImag = m_paramVTS->getRawParameterValue(paramPoleImag.ID[sossec]);
-        float imagvalpole = *poleImag;
-
-        if ((isPoleOn > 0.5) && (isPoleConj < 0.5)) // odd filter
+        const SOSParameter& params = m_sosParams[sossec];
+        float target[nrofRampedCoordinates] = {*params.poleReal, *params.poleImag, *params.zeroReal, *params.zeroImag};
+        for (int coord = 0; coord < nrofRampedCoordinates; ++coord)
         {
-            a2 = 0.0;
-            a1 = -realvalpole;
+            m_rampStart[coord][sossec] = m_rampValid ? m_rampEnd[coord][sossec] : target[coord];
+            m_rampEnd[coord][sossec] = target[coord];
+            m_rampActive = m_rampActive || m_rampStart[coord][sossec] != target[coord];
         }
-        if ((isPoleOn > 0.5) && (isPoleConj > 0.5)) // even filter
+    }
+    float gainValdB = *m_gain;
+    m_rampGainStart_dB = m_rampValid ? m_rampGainEnd_dB : gainValdB;
+    m_rampGainEnd_dB = gainValdB;
+    m_rampActive = m_rampActive || m_rampGainStart_dB != gainValdB;
+    m_rampValid = true;
+}
+
+/**
+ * Computes the coefficients of all second order sections from the ramped
+ * parameter values and the modulation offsets. The sections are handled as
+ * arrays (structure of arrays), so the loops over the sections vectorise.
+ * If pole protection rejects a section, the last valid coefficients of this
+ * section are kept. Without modulation nothing is computed as long as the
+ * version of the filter model is unchanged.
+ *
+ * \param coeffs array of m_nrofSOS coefficient sets to fill
+ * \return bit mask of the sections that differ from the last call
+ */
+uint32 FilterDeMystifierAudioProcessor::updateCoeffs(SOSCoeffs* coeffs)
+{
+    bool poleProtect = *m_poleProtect > 0.5f;
+    bool modActive = m_modulation.isActive();
+
+    // read the version before the parameters, a change in between is caught next time
+    uint32 modelVersion = m_filterModel.getVersion();
+    if (!modActive && !m_lastCoeffsModulated && !m_rampActive && modelVersion == m_lastModelVersion
+        && poleProtect == m_lastPoleProtect)
+    {
+        for (int sossec = 0 ; sossec < m_nrofSOS ; ++sossec )
+            coeffs[sossec] = m_lastCoeffs[sossec];
+        return 0;
+    }
+    m_lastModelVersion = modelVersion;
+    m_lastCoeffsModulated = modActive;
+    m_lastPoleProtect = poleProtect;
+
+    float poleOn[MAX_POLE_INSTANCES], poleConj[MAX_POLE_INSTANCES];
+    float poleRe[MAX_POLE_INSTANCES], poleIm[MAX_POLE_INSTANCES];
+    float zeroOn[MAX_POLE_INSTANCES], zeroConj[MAX_POLE_INSTANCES];
+    float zeroRe[MAX_POLE_INSTANCES], zeroIm[MAX_POLE_INSTANCES];
+    // switches are not ramped
+    float pos = m_rampPosition;
+    for (int sossec = 0 ; sossec < m_nrofSOS ; ++sossec )
+    {
+        const SOSParameter& params = m_sosParams[sossec];
+        poleOn[sossec] = *params.poleOn;
+        poleConj[sossec] = *params.poleConj;
+        zeroOn[sossec] = *params.zeroOn;
+        zeroConj[sossec] = *params.zeroConj;
+    }
+    for (int sossec = 0 ; sossec < m_nrofSOS ; ++sossec )
+    {
+        poleRe[sossec] = m_rampStart[rampPoleReal][sossec] + pos*(m_rampEnd[rampPoleReal][sossec] - m_rampStart[rampPoleReal][sossec]);
+        poleIm[sossec] = m_rampStart[rampPoleImag][sossec] + pos*(m_rampEnd[rampPoleImag][sossec] - m_rampStart[rampPoleImag][sossec]);
+        zeroRe[sossec] = m_rampStart[rampZeroReal][sossec] + pos*(m_rampEnd[rampZeroReal][sossec] - m_rampStart[rampZeroReal][sossec]);
+        zeroIm[sossec] = m_rampStart[rampZeroImag][sossec] + pos*(m_rampEnd[rampZeroImag][sossec] - m_rampStart[rampZeroImag][sossec]);
+    }
+
+    float gainValdB = m_rampGainStart_dB + pos*(m_rampGainEnd_dB - m_rampGainStart_dB);
+    if (modActive)
+    {
+        // move the roots in polar coordinates (radius and angle)
+        float poleRadiusOffset[MAX_POLE_INSTANCES], poleAngleOffset[MAX_POLE_INSTANCES];
+        float zeroRadiusOffset[MAX_POLE_INSTANCES], zeroAngleOffset[MAX_POLE_INSTANCES];
+        for (int sossec = 0 ; sossec < MAX_POLE_INSTANCES ; ++sossec )
         {
-            a2 = realvalpole*realvalpole + imagvalpole*imagvalpole;
-            a1 = -2*realvalpole;
+            poleRadiusOffset[sossec] = m_modulation.getRadiusOffset(sossec, true);
+            poleAngleOffset[sossec] = m_modulation.getAngleOffset(sossec, true);
+            zeroRadiusOffset[sossec] = m_modulation.getRadiusOffset(sossec, false);
+            zeroAngleOffset[sossec] = m_modulation.getAngleOffset(sossec, false);
         }
+        float maxPoleRadius = poleProtect ? 0.99f : paramPoleReal.maxValue;
+        modulateRoots(poleRe, poleIm, poleConj, poleRadiusOffset, poleAngleOffset, maxPoleRadius);
+        modulateRoots(zeroRe, zeroIm, zeroConj, zeroRadiusOffset, zeroAngleOffset, paramZeroReal.maxValue);
+        gainValdB = jlimit(paramb0.minValue, paramb0.maxValue, gainValdB + m_modulation.getGainOffset_dB());
+    }
 
+    // odd filter: 1 - re z^-1, even filter: 1 - 2 re z^-1 + (re^2+im^2) z^-2
+    float b0[MAX_POLE_INSTANCES], b1[MAX_POLE_INSTANCES], b2[MAX_POLE_INSTANCES];
+    float a1[MAX_POLE_INSTANCES], a2[MAX_POLE_INSTANCES];
+    for (int sossec = 0 ; sossec < MAX_POLE_INSTANCES ; ++sossec )
+    {
+        rootToSOSCoeffs(poleOn[sossec] > 0.5f ? 1.f : 0.f, poleConj[sossec] > 0.5f ? 1.f : 0.f,
+            poleRe[sossec], poleIm[sossec], a1[sossec], a2[sossec]);
 
-        // Zeros second
-        auto zeroOn = m_paramVTS->getRawParameterValue(paramZeroBool.ID[sossec]);
-        float isZeroOn = *zeroOn;
-        auto zeroWithConj = m_paramVTS->getRawParameterValue(paramZeroConjugated.ID[sossec]);
-        float isZeroConj = *zeroWithConj;
+        b0[sossec] = 1.f;
+        rootToSOSCoeffs(zeroOn[sossec] > 0.5f ? 1.f : 0.f, zeroConj[sossec] > 0.5f ? 1.f : 0.f,
+            zeroRe[sossec], zeroIm[sossec], b1[sossec], b2[sossec]);
+    }
 
-        auto zeroReal = m_paramVTS->getRawParameterValue(paramZeroReal.ID[sossec]);
-        float realvalzero =  *zeroReal;
-        auto zeroImag = m_paramVTS->getRawParameterValue(paramZeroImag.ID[sossec]);
-        float imagvalzero =  *zeroImag;
+    // the gain is part of the first section
+    float gainlin = pow(10.f,gainValdB/20.0);
+    b0[0] *= gainlin;
+    b1[0] *= gainlin;
+    b2[0] *= gainlin; 
 
-        if ((isZeroOn > 0.5) && (isZeroConj < 0.5)) // odd filter
-        {
-            b2 = 0.0;
-            b1 = -realvalzero;
-        }
-        if ((isZeroOn > 0.5) && (isZeroConj > 0.5)) // even filter
+    uint32 changed = 0;
+    for (int sossec = 0 ; sossec < m_nrofSOS ; ++sossec )
+    {
+        bool accept = isSectionAccepted(poleProtect, poleConj[sossec] > 0.5f, a1[sossec], a2[sossec]);
+        SOSCoeffs newCoeffs = {b0[sossec], b1[sossec], b2[sossec], a1[sossec], a2[sossec]};
+        if (accept && newCoeffs != m_lastCoeffs[sossec])
         {
-            b2 = realvalzero*realvalzero + imagvalzero*imagvalzero;
-            b1 = -2*realvalzero;
+            m_lastCoeffs[sossec] = newCoeffs;
+            changed |= 1u << sossec;
         }
-        
-        if (sossec == 0)
+        coeffs[sossec] = m_lastCoeffs[sossec];
+    }
+    return changed;
+}
+
+/**
+ * Adds the modulation offsets to the roots of all sections, given in
+ * cartesian coordinates (arrays of MAX_POLE_INSTANCES). Conjugated roots are
+ * moved in radius and angle, real roots (odd filter) can only be moved along
+ * the real axis, so only the radius is used. Both cases are computed for all
+ * sections and selected per section, so the loop has no branches and
+ * vectorises (GCC needs -fno-math-errno and -fno-trapping-math for the
+ * sqrt and the selects). A root without offsets is kept exactly.
+ */
+void FilterDeMystifierAudioProcessor::modulateRoots(float* re, float* im, const float* isConj,
+    const float* radiusOffset, const float* angleOffset, float maxRadius)
+{
+    for (int sossec = 0 ; sossec < MAX_POLE_INSTANCES ; ++sossec )
+    {
+        float oldRe = re[sossec];
+        float oldIm = im[sossec];
+        bool conj = isConj[sossec] > 0.5f;
+        // bitwise or, the short circuit would be a branch
+        bool moved = (radiusOffset[sossec] != 0.f) | (angleOffset[sossec] != 0.f);
+
+        // real root: |re|, conjugated root: |re + j im|
+        float imConj = conj ? oldIm : 0.f;
+        float radius = std::sqrt(oldRe*oldRe + imConj*imConj) + radiusOffset[sossec];
+        radius = radius < 0.f ? 0.f : (radius > maxRadius ? maxRadius : radius);
+
+        // the angle stays in the upper half plane, the conjugate is added by the section
+        float angle = fastAtan2(imConj, oldRe) + angleOffset[sossec];
+        angle = angle < 0.f ? 0.f : (angle > g_fastPi ? g_fastPi : angle);
+        float cosAngle = fastCos(angle);
+        float sinAngle = fastSin(angle);
+
+        float realRe = oldRe < 0.f ? -radius : radius;
+        float newRe = conj ? radius*cosAngle : realRe;
+        float newIm = conj ? radius*sinAngle : oldIm;
+        re[sossec] = moved ? newRe : oldRe;
+        im[sossec] = moved ? newIm : oldIm;
+    }
+}
+
+/**
+ * Splits the block into sub blocks of m_controlRateSamples and computes the
+ * coefficients once per sub block. The root coordinates and the gain are
+ * ramped across the sub blocks and reach the current parameter values with
+ * the last one. Only the sections with new coefficients are marked as
+ * changed per sub block, so the (cross faded) coefficient switch in a SOS
+ * filter only happens if its own coefficients really moved.
+ *
+ * MIDI events are passed to the resonator voices at the sub block they fall
+ * into, so note on/off is resolved with the control rate.
+ *
+ * \param buffer input block, used by the envelope follower of the modulation
+ * \param midiMessages MIDI events of this block
+ * \return number of control points used
+ */
+int FilterDeMystifierAudioProcessor::buildControlPoints(const AudioBuffer<float>& buffer, const MidiBuffer& midiMessages)
+{
+    int nrofsamples = buffer.getNumSamples();
+    int maxPoints = static_cast<int>(m_controlPoints.size());
+    int step = m_controlRateSamples;
+    if (maxPoints == 0)
+        return 0;
+
+    // the host is allowed to send larger blocks than announced, do not allocate here
+    if ((nrofsamples + step - 1) / step > maxPoints)
+        step = (nrofsamples + maxPoints - 1) / maxPoints;
+
+    startParameterRamp();
+
+    int nrofPoints = 0;
+    auto midiEvent = midiMessages.begin();
+    for (int start = 0; start < nrofsamples; start += step)
+    {
+        ControlPoint& cp = m_controlPoints[nrofPoints];
+        cp.startSample = start;
+        cp.nrofSamples = jmin(step, nrofsamples - start);
+
+        for (; midiEvent != midiMessages.end() && (*midiEvent).samplePosition < start + cp.nrofSamples; ++midiEvent)
+            m_voices.handleMidiEvent((*midiEvent).getMessage());
+
+        m_voices.processControlPoint(nrofPoints, cp.nrofSamples);
+        m_modulation.processControlPoint(buffer, cp.startSample, cp.nrofSamples);
+        m_rampPosition = static_cast<float>(cp.startSample + cp.nrofSamples) / nrofsamples;
+        cp.changedSections = updateCoeffs(cp.coeffs);
+        nrofPoints++;
+    }
+    return nrofPoints;
+}
+
+/**
+ * Runs the filter cascade (and the resonator voices) on one channel for all
+ * control points of the current block. Called from the worker pool, so only
+ * state of this channel may be changed here.
+ */
+void FilterDeMystifierAudioProcessor::processChannel(int channel)
+{
+    auto* channelData = m_processBuffer->getWritePointer (channel);
+    for (auto kk = 0; kk < m_nrofSOS; kk++)
+        m_filter[channel][kk].setUseNL(m_sectionClipping);
+
+    for (auto cc = 0; cc < m_nrofControlPoints; ++cc)
+    {
+        const ControlPoint& cp = m_controlPoints[cc];
+        float* subBlock = channelData + cp.startSample;
+        for (auto kk = 0; kk < m_nrofSOS; kk++)
         {
-            auto gain = m_paramVTS->getRawParameterValue(paramb0.ID);
-            float gainValdB = *gain;
-            float gainlin = pow(10.f,gainValdB/20.0);
-            b0 *= gainlin;
-            b1 *= gainlin;
-            b2 *= gainlin; 
-        }
-        if ((poleProtect == true) && a2 < 1)
-        {   
-            if ((isPoleConj > 0.5))
+            if (cp.changedSections & (1u << kk))
             {
-                m_filter[0][sossec].setCoeffs(b0,b1,b2,a1,a2);
-                m_filter[1][sossec].setCoeffs(b0,b1,b2,a1,a2);
-            }
-            else
-            { 
-                if (abs(a1) < 0.998)
-                {
-                    m_filter[0][sossec].setCoeffs(b0,b1,b2,a1,a2);
-                    m_filter[1][sossec].setCoeffs(b0,b1,b2,a1,a2);
-                }
+                const SOSCoeffs& c = cp.coeffs[kk];
+                m_filter[channel][kk].setCoeffs(c.b0, c.b1, c.b2, c.a1, c.a2);
             }
+            m_filter[channel][kk].processDataTV(subBlock, subBlock, cp.nrofSamples);
+            // the sub-block is still in the cache
+            if (m_sectionTapsActive)
+                m_sectionMeter.tap(channel, kk, subBlock, cp.nrofSamples);
         }
-        else 
+        // key tracked resonators work on the filtered signal
+        if (m_voicesActive)
+            m_voices.processChannel(channel, cc, subBlock, cp.nrofSamples);
+    }
+
+    int nrofsamples = m_processBuffer->getNumSamples();
+    if (!isBlockHealthy(channelData, nrofsamples))
+        recoverChannel(channel, channelData, nrofsamples);
+}
+
+/**
+ * One reduction over the block instead of clipping every sample: the sum of
+ * absolute values is NaN or Inf if any sample is, the maximum is large if the
+ * cascade runs away. Only a block with a sample above HEALTH_MAX_VALUE is a
+ * fault, a loud but stable design is left to the limiter. Four partial sums
+ * and maxima keep the loop vectorisable.
+ */
+bool FilterDeMystifierAudioProcessor::isBlockHealthy(const float* data, int nrofsamples)
+{
+    // hosts send empty blocks, there is nothing to judge
+    if (nrofsamples <= 0)
+        return true;
+
+    float sum0 = 0.f, sum1 = 0.f, sum2 = 0.f, sum3 = 0.f;
+    float max0 = 0.f, max1 = 0.f, max2 = 0.f, max3 = 0.f;
+    int kk = 0;
+    for (; kk + 3 < nrofsamples; kk += 4)
+    {
+        float abs0 = std::abs(data[kk]);
+        float abs1 = std::abs(data[kk + 1]);
+        float abs2 = std::abs(data[kk + 2]);
+        float abs3 = std::abs(data[kk + 3]);
+        sum0 += abs0;
+        sum1 += abs1;
+        sum2 += abs2;
+        sum3 += abs3;
+        max0 = jmax(max0, abs0);
+        max1 = jmax(max1, abs1);
+        max2 = jmax(max2, abs2);
+        max3 = jmax(max3, abs3);
+    }
+    for (; kk < nrofsamples; ++kk)
+    {
+        float abs0 = std::abs(data[kk]);
+        sum0 += abs0;
+        max0 = jmax(max0, abs0);
+    }
+
+    float sum = (sum0 + sum1) + (sum2 + sum3);
+    float maxAbs = jmax(jmax(max0, max1), jmax(max2, max3));
+    // every comparison with NaN is false, so NaN is unhealthy too (the maximum may skip it, the sum does not)
+    return maxAbs < HEALTH_MAX_VALUE && sum < HEALTH_MAX_VALUE*nrofsamples;
+}
+
+/**
+ * Resets the sections of this channel whose states are no longer finite or
+ * ran away. If the states look fine (the block only had a short burst), all
+ * sections of the channel are reset. The block itself is muted, so the limiter
+ * never sees invalid values.
+ */
+void FilterDeMystifierAudioProcessor::recoverChannel(int channel, float* data, int nrofsamples)
+{
+    bool anyReset = false;
+    for (auto kk = 0; kk < m_nrofSOS; kk++)
+    {
+        if (!m_filter[channel][kk].isStateHealthy(HEALTH_MAX_VALUE))
         {
-            if  (poleProtect == false)
-            {
-                m_filter[0][sossec].setCoeffs(b0,b1,b2,a1,a2);
-                m_filter[1][sossec].setCoeffs(b0,b1,b2,a1,a2);
-            }
+            m_filter[channel][kk].recover();
+            anyReset = true;
         }
     }
-    bool bypassLimiter = m_paramVTS->getParameter(paramLimiterBool.ID)->getValue();
+    if (!anyReset)
+    {
+        for (auto kk = 0; kk < m_nrofSOS; kk++)
+            m_filter[channel][kk].recover();
+    }
+    m_voices.resetChannel(channel);
+    FloatVectorOperations::clear(data, nrofsamples);
+    m_healthEvents++;
+}
+
+void FilterDeMystifierAudioProcessor::processBlock (AudioBuffer<float>& buffer, MidiBuffer& midiMessages)
+{
+    bool bypassLimiter = *m_limiterOn > 0.5f;
     m_limiter.setBypass(!bypassLimiter);
     ScopedLock Sp(objectLock);
 
@@ -289,36 +586,27 @@ void FilterDeMystifierAudioProcessor::processBlock (AudioBuffer<float>& buffer,
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    // This is the place where you'd normally do the guts of your plugin's
-    // audio processing...
-    // Make sure to reset the state if your inner loop is processing
-    // the samples and the outer loop is handling the channels.
-    // Alternatively, you can process the samples with the channels
-    // interleaved by keeping the same state.
-    
-    m_data.resize(buffer.getNumSamples());
+    // The roots and the gain are ramped from the last block to the current
+    // parameter values at the control rate, so automated sweeps are followed
+    // within the block instead of jumping at the block start.
+    m_nrofControlPoints = buildControlPoints(buffer, midiMessages);
+    m_voicesActive = m_voices.isActive();
+    m_sectionClipping = useSectionClipping(*m_poleProtect > 0.5f);
+    m_sectionTapsActive = m_sectionMeter.isActive();
 
-    for (int channel = 0; channel < totalNumInputChannels; ++channel)
-    {
-        auto* channelData = buffer.getWritePointer (channel);
+    // only copies into a FIFO (if the analyser is shown at all)
+    m_spectrumAnalyser.pushInput(buffer, totalNumInputChannels);
 
-        // change to vector
-        for (auto idx = 0u; idx < buffer.getNumSamples(); idx++)
-        {
-            m_data[idx] = channelData[idx];
-        }
-        for (auto kk = 0; kk < m_nrofSOS; kk++)
-        {
-            m_filter[channel][kk].processDataTV(m_data,m_data);
-        }
-        for (auto idx = 0u; idx < buffer.getNumSamples(); idx++)
-        {
-            channelData[idx] = m_data[idx];
-        }
-    }
+    // the channel loop runs on the worker pool (or serial for small blocks)
+    m_processBuffer = &buffer;
+    m_workerPool.run(*this, jmin(totalNumInputChannels, m_nrofinputchannels), buffer.getNumSamples());
+    m_processBuffer = nullptr;
+    if (m_sectionTapsActive)
+        m_sectionMeter.analyseBlock(jmin(totalNumInputChannels, m_nrofinputchannels), buffer.getNumSamples());
 
     m_limiter.processSamples(buffer);
     m_meter.analyseData(buffer);
+    m_spectrumAnalyser.pushOutput(buffer, totalNumOutputChannels);
 }
 
 //==============================================================================
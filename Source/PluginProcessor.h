@@ -20,11 +20,20 @@
 #include "SOSFilter.h"
 #include "BrickwallLimiter.h"
 #include "SimpleMeter.h"
+#include "SpectrumAnalyser.h"
+#include "SectionMeter.h"
+#include "ModulationMatrix.h"
+#include "ResonatorVoiceBank.h"
+#include "ChannelWorkerPool.h"
+#include "FilterModel.h"
+
+// coefficients are (re)computed every CONTROL_RATE_SAMPLES within a block
+#define CONTROL_RATE_SAMPLES 32
 
 //==============================================================================
 /**
 */
-class FilterDeMystifierAudioProcessor  : public AudioProcessor
+class FilterDeMystifierAudioProcessor  : public AudioProcessor, private ChannelWorkerPool::Job
 {
 public:
     //==============================================================================
@@ -63,7 +72,24 @@ public:
     //==============================================================================
     void getStateInformation (MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
+
+    //==============================================================================
+    void setControlRate (int nrofsamples) { m_controlRateSamples = jmax(1, nrofsamples); };
+    int getControlRate () const { return m_controlRateSamples; };
+    // number of additional threads for the channel loop, -1: automatic, 0: serial (used by the next prepareToPlay)
+    void setMaxWorkerThreads (int nrofthreads) { m_maxWorkerThreads = nrofthreads; };
+    // number of blocks (per channel) where NaN, Inf or runaway values had to be removed
+    int getNumHealthEvents () const { return m_healthEvents.load(); };
+
+    // shared snapshot of the pole/zero parameters for all views
+    FilterModelStore& getFilterModelStore () { return m_filterModel; };
+    // for the gain reduction history in the GUI
+    BrickwallLimiter<float>& getLimiter () { return m_limiter; };
+
     SimpleMeter m_meter;
+    SpectrumAnalyser m_spectrumAnalyser;
+    // levels after each section of the cascade
+    SectionMeter m_sectionMeter;
 private:
     // PARAMETER HANDLING 
     std::unique_ptr<AudioProcessorValueTreeState> m_paramVTS;
@@ -72,17 +98,100 @@ private:
     CriticalSection objectLock;
 
     PNParameter m_PNparams;
+    FilterModelStore m_filterModel;
+    ModulationParameter m_modParams;
+    ModulationMatrix m_modulation;
+    ResonatorVoiceParameter m_voiceParams;
+    ResonatorVoiceBank m_voices;
+    bool m_voicesActive;
+    // set once per block from the pole protection (useSectionClipping)
+    bool m_sectionClipping;
+    bool m_sectionTapsActive;
 
     std::vector<std::vector<SOSFilter<float> > > m_filter;
-    const int m_nrofinputchannels = 8;
-    const int m_nrofSOS = 4;
-    std::vector<float> m_data;
-
-    std::atomic<float>* m_poleOn;
-    std::atomic<float>* m_zeroOn;
+    const int m_nrofinputchannels = 64;
+    const int m_nrofSOS = MAX_POLE_INSTANCES;
+
+    // raw parameter pointers of one second order section (avoids the string lookup in processBlock)
+    struct SOSParameter
+    {
+        std::atomic<float>* poleOn;
+        std::atomic<float>* poleConj;
+        std::atomic<float>* poleReal;
+        std::atomic<float>* poleImag;
+        std::atomic<float>* zeroOn;
+        std::atomic<float>* zeroConj;
+        std::atomic<float>* zeroReal;
+        std::atomic<float>* zeroImag;
+    };
+    SOSParameter m_sosParams[MAX_POLE_INSTANCES];
+    std::atomic<float>* m_gain;
+    std::atomic<float>* m_poleProtect;
+    std::atomic<float>* m_limiterOn;
+
+    struct SOSCoeffs
+    {
+        float b0, b1, b2, a1, a2;
+        bool operator!= (const SOSCoeffs& other) const
+        {
+            return b0 != other.b0 || b1 != other.b1 || b2 != other.b2 || a1 != other.a1 || a2 != other.a2;
+        };
+    };
+    // one entry per sub block, the coefficients are valid from startSample on
+    struct ControlPoint
+    {
+        int startSample;
+        int nrofSamples;
+        // bit kk is set if section kk has new coefficients
+        uint32 changedSections;
+        SOSCoeffs coeffs[MAX_POLE_INSTANCES];
+    };
+    std::vector<ControlPoint> m_controlPoints;
+    int m_nrofControlPoints;
+    int m_controlRateSamples;
+    SOSCoeffs m_lastCoeffs[MAX_POLE_INSTANCES];
+    // coefficients are only recomputed if the model version changed, modulation runs or a ramp is active
+    uint32 m_lastModelVersion;
+    bool m_lastCoeffsModulated;
+    bool m_lastPoleProtect;
+
+    // the root coordinates and the gain are ramped linearly across the control points
+    // of a block, from the values at the end of the last block to the current ones
+    enum RampedCoordinates
+    {
+        rampPoleReal,
+        rampPoleImag,
+        rampZeroReal,
+        rampZeroImag,
+        nrofRampedCoordinates
+    };
+    float m_rampStart[nrofRampedCoordinates][MAX_POLE_INSTANCES];
+    float m_rampEnd[nrofRampedCoordinates][MAX_POLE_INSTANCES];
+    float m_rampGainStart_dB;
+    float m_rampGainEnd_dB;
+    // 0 ... 1, position at the end of the current control point
+    float m_rampPosition;
+    bool m_rampActive;
+    bool m_rampValid;
+    void startParameterRamp();
+
+    int buildControlPoints(const AudioBuffer<float>& buffer, const MidiBuffer& midiMessages);
+    uint32 updateCoeffs(SOSCoeffs* coeffs);
+    static void modulateRoots(float* re, float* im, const float* isConj,
+        const float* radiusOffset, const float* angleOffset, float maxRadius);
 
     BrickwallLimiter<float> m_limiter;
 
+    // channels are independent up to the limiter, so they can run in parallel
+    ChannelWorkerPool m_workerPool;
+    int m_maxWorkerThreads;
+    AudioBuffer<float>* m_processBuffer;
+    void processChannel(int channel) override;
+
+    std::atomic<int> m_healthEvents;
+    static bool isBlockHealthy(const float* data, int nrofsamples);
+    void recoverChannel(int channel, float* data, int nrofsamples);
+
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FilterDeMystifierAudioProcessor)
 };
@@ -0,0 +1,264 @@
+/*
+  ==============================================================================
+    ResonatorVoiceBank.cpp
+
+    Authors:    agent
+
+    SPDX-License-Identifier: BSD-3-Clause
+ ==============================================================================
+*/
+
+#include "ResonatorVoiceBank.h"
+
+// attack of a new voice, short enough to follow the note but without a click
+#define VOICE_ATTACK_MS 5.f
+// highest resonance frequency relative to fs
+#define VOICE_MAX_FREQ_REL 0.49
+
+int ResonatorVoiceParameter::addParameter(std::vector<std::unique_ptr<RangedAudioParameter>>& paramVector)
+{
+	paramVector.push_back(std::make_unique<AudioParameterBool>(paramKeyTrackBool.ID,
+		paramKeyTrackBool.name,
+		paramKeyTrackBool.defaultValue));
+
+	paramVector.push_back(std::make_unique<AudioParameterFloat>(paramVoiceRadius.ID,
+		paramVoiceRadius.name,
+		NormalisableRange<float>(paramVoiceRadius.minValue, paramVoiceRadius.maxValue, 0.f, 2.f),
+		paramVoiceRadius.defaultValue,
+		paramVoiceRadius.unitName,
+		AudioProcessorParameter::genericParameter,
+		[](float value, int MaxLen) {return String(value, 4).substring(0, MaxLen);},
+		[](const String& text) {return text.getFloatValue();}));
+
+	paramVector.push_back(std::make_unique<AudioParameterFloat>(paramVoiceRelease.ID,
+		paramVoiceRelease.name,
+		NormalisableRange<float>(paramVoiceRelease.minValue, paramVoiceRelease.maxValue, 0.f, 0.3f),
+		paramVoiceRelease.defaultValue,
+		paramVoiceRelease.unitName,
+		AudioProcessorParameter::genericParameter,
+		[](float value, int MaxLen) {return String(value, 1).substring(0, MaxLen);},
+		[](const String& text) {return text.getFloatValue();}));
+	return 1;
+}
+
+ResonatorVoiceBank::ResonatorVoiceBank()
+:m_fs(48000.0),m_ageCounter(0),m_pendingReset(0),
+m_keyTrackOn(nullptr),m_voiceRadius(nullptr),m_voiceRelease(nullptr)
+{
+    reset();
+}
+
+void ResonatorVoiceBank::prepareParameter(std::unique_ptr<AudioProcessorValueTreeState>& vts)
+{
+    m_keyTrackOn = vts->getRawParameterValue(paramKeyTrackBool.ID);
+    m_voiceRadius = vts->getRawParameterValue(paramVoiceRadius.ID);
+    m_voiceRelease = vts->getRawParameterValue(paramVoiceRelease.ID);
+}
+
+void ResonatorVoiceBank::prepareToPlay(double sampleRate, int maxControlPoints, int nrofchannels)
+{
+    m_fs = sampleRate;
+    m_snapshots.resize(maxControlPoints);
+    m_states.resize(nrofchannels);
+    reset();
+}
+
+void ResonatorVoiceBank::reset()
+{
+    for (auto vv = 0; vv < MAX_RESONATOR_VOICES; ++vv)
+    {
+        m_note[vv] = -1;
+        m_gateOn[vv] = false;
+        m_velocity[vv] = 0.f;
+        m_gain[vv] = 0.f;
+        m_cosTheta[vv] = 1.f;
+        m_age[vv] = 0;
+    }
+    m_ageCounter = 0;
+    m_pendingReset = 0;
+    for (auto cc = 0; cc < static_cast<int>(m_states.size()); ++cc)
+        resetChannel(cc);
+}
+
+void ResonatorVoiceBank::resetChannel(int channel)
+{
+    if (channel >= static_cast<int>(m_states.size()))
+        return;
+
+    ChannelState& state = m_states[channel];
+    std::fill(std::begin(state.y1), std::end(state.y1), 0.f);
+    std::fill(std::begin(state.y2), std::end(state.y2), 0.f);
+    state.x1 = state.x2 = 0.f;
+}
+
+void ResonatorVoiceBank::handleMidiEvent(const MidiMessage& message)
+{
+    if (message.isNoteOn())
+        noteOn(message.getNoteNumber(), message.getFloatVelocity());
+    else if (message.isNoteOff())
+        noteOff(message.getNoteNumber());
+    else if (message.isAllNotesOff() || message.isAllSoundOff())
+        allNotesOff();
+}
+
+void ResonatorVoiceBank::noteOn(int note, float velocity)
+{
+    double freq = MidiMessage::getMidiNoteInHertz(note);
+    if (freq >= VOICE_MAX_FREQ_REL*m_fs)
+        return;
+
+    // a retriggered note keeps its voice
+    int voice = -1;
+    for (auto vv = 0; vv < MAX_RESONATOR_VOICES; ++vv)
+    {
+        if (m_note[vv] == note)
+        {
+            voice = vv;
+            break;
+        }
+    }
+    if (voice < 0)
+    {
+        voice = findFreeVoice();
+        m_pendingReset |= (1u << voice);
+        m_gain[voice] = 0.f;
+    }
+    m_note[voice] = note;
+    m_gateOn[voice] = true;
+    m_velocity[voice] = velocity;
+    m_cosTheta[voice] = static_cast<float>(std::cos(2.0*MathConstants<double>::pi*freq/m_fs));
+    m_age[voice] = ++m_ageCounter;
+}
+
+void ResonatorVoiceBank::noteOff(int note)
+{
+    for (auto vv = 0; vv < MAX_RESONATOR_VOICES; ++vv)
+    {
+        if (m_note[vv] == note)
+            m_gateOn[vv] = false;
+    }
+}
+
+void ResonatorVoiceBank::allNotesOff()
+{
+    for (auto vv = 0; vv < MAX_RESONATOR_VOICES; ++vv)
+        m_gateOn[vv] = false;
+}
+
+/**
+ * returns an idle voice. If all voices are in use, the oldest released voice
+ * is stolen, and if no voice is released the oldest held one.
+ */
+int ResonatorVoiceBank::findFreeVoice()
+{
+    int oldestReleased = -1;
+    int oldestHeld = 0;
+    for (auto vv = 0; vv < MAX_RESONATOR_VOICES; ++vv)
+    {
+        if (m_note[vv] < 0)
+            return vv;
+
+        if (!m_gateOn[vv])
+        {
+            if (oldestReleased < 0 || m_age[vv] < m_age[oldestReleased])
+                oldestReleased = vv;
+        }
+        else if (m_age[vv] < m_age[oldestHeld])
+            oldestHeld = vv;
+    }
+    return oldestReleased >= 0 ? oldestReleased : oldestHeld;
+}
+
+void ResonatorVoiceBank::processControlPoint(int controlPoint, int nrofsamples)
+{
+    if (controlPoint >= static_cast<int>(m_snapshots.size()))
+        return;
+
+    VoiceSnapshot& snap = m_snapshots[controlPoint];
+    snap.resetMask = m_pendingReset;
+    m_pendingReset = 0;
+
+    float radius = *m_voiceRadius;
+    float attackStep = nrofsamples/(0.001f*VOICE_ATTACK_MS*static_cast<float>(m_fs));
+    float releaseStep = nrofsamples/(0.001f*(*m_voiceRelease)*static_cast<float>(m_fs));
+
+    // peak gain of (1-r^2)/2 (1 - z^-2)/(1 - 2r cos(theta) z^-1 + r^2 z^-2) is one
+    float b0 = 0.5f*(1.f - radius*radius);
+    float a2 = radius*radius;
+    for (auto vv = 0; vv < MAX_RESONATOR_VOICES; ++vv)
+    {
+        snap.gainStart[vv] = m_gain[vv];
+        if (m_gateOn[vv])
+            m_gain[vv] = jmin(m_velocity[vv], m_gain[vv] + attackStep*m_velocity[vv]);
+        else
+            m_gain[vv] = jmax(0.f, m_gain[vv] - releaseStep*m_velocity[vv]);
+
+        snap.gainEnd[vv] = m_gain[vv];
+
+        // released voice has faded out, give it back to the pool
+        if (!m_gateOn[vv] && m_gain[vv] == 0.f)
+            m_note[vv] = -1;
+
+        bool isUsed = m_note[vv] >= 0 || snap.gainStart[vv] > 0.f;
+        snap.b0[vv] = isUsed ? b0 : 0.f;
+        snap.a1[vv] = -2.f*radius*m_cosTheta[vv];
+        snap.a2[vv] = a2;
+    }
+}
+
+void ResonatorVoiceBank::processChannel(int channel, int controlPoint, float* data, int nrofsamples)
+{
+    if (channel >= static_cast<int>(m_states.size()) || controlPoint >= static_cast<int>(m_snapshots.size()))
+        return;
+
+    const VoiceSnapshot& snap = m_snapshots[controlPoint];
+    ChannelState& state = m_states[channel];
+
+    // local copies, so the compiler keeps the lanes in registers
+    float y1[MAX_RESONATOR_VOICES], y2[MAX_RESONATOR_VOICES];
+    float gain[MAX_RESONATOR_VOICES], gainInc[MAX_RESONATOR_VOICES];
+    float invN = 1.f/nrofsamples;
+    for (auto vv = 0; vv < MAX_RESONATOR_VOICES; ++vv)
+    {
+        bool resetVoice = (snap.resetMask >> vv) & 1u;
+        y1[vv] = resetVoice ? 0.f : state.y1[vv];
+        y2[vv] = resetVoice ? 0.f : state.y2[vv];
+        gain[vv] = snap.gainStart[vv];
+        gainInc[vv] = (snap.gainEnd[vv] - snap.gainStart[vv])*invN;
+    }
+    float x1 = state.x1;
+    float x2 = state.x2;
+
+    // all voices are computed, idle ones have b0 = 0 and zero gain.
+    // The fixed trip count of the inner loop lets it run in SIMD lanes.
+    for (auto kk = 0; kk < nrofsamples; ++kk)
+    {
+        float in = data[kk];
+        float xd = in - x2;
+        x2 = x1;
+        x1 = in;
+
+        float out[MAX_RESONATOR_VOICES];
+        for (auto vv = 0; vv < MAX_RESONATOR_VOICES; ++vv)
+        {
+            float y = snap.b0[vv]*xd - snap.a1[vv]*y1[vv] - snap.a2[vv]*y2[vv];
+            y2[vv] = y1[vv];
+            y1[vv] = y;
+            out[vv] = gain[vv]*y;
+            gain[vv] += gainInc[vv];
+        }
+        float sum = 0.f;
+        for (auto vv = 0; vv < MAX_RESONATOR_VOICES; ++vv)
+            sum += out[vv];
+
+        data[kk] = sum;
+    }
+
+    for (auto vv = 0; vv < MAX_RESONATOR_VOICES; ++vv)
+    {
+        state.y1[vv] = y1[vv];
+        state.y2[vv] = y2[vv];
+    }
+    state.x1 = x1;
+    state.x2 = x2;
+}
@@ -0,0 +1,125 @@
+/*
+  ==============================================================================
+    ResonatorVoiceBank.h
+
+    Key tracked resonator voices. Incoming MIDI notes allocate voices from a
+    preallocated pool. Every voice is a two pole resonator whose pole angle
+    follows the note pitch. All voices are computed together in a structure of
+    arrays (one SIMD lane per voice), so the cost does not depend on the number
+    of held notes.
+
+    Authors:    agent
+
+    SPDX-License-Identifier: BSD-3-Clause
+ ==============================================================================
+*/
+
+#pragma once
+
+#include <vector>
+#include <JuceHeader.h>
+
+#define MAX_RESONATOR_VOICES 16
+
+const struct
+{
+	const std::string ID = "keyTrackBool";
+	std::string name = "Key tracking";
+	std::string unitName = "";
+	bool defaultValue = false;
+}paramKeyTrackBool;
+
+const struct
+{
+	const std::string ID = "VoiceRadius";
+	std::string name = "Voice resonance";
+	std::string unitName = "";
+	float minValue = 0.9f;
+	float maxValue = 0.9999f;
+	float defaultValue = 0.995f;
+}paramVoiceRadius;
+
+const struct
+{
+	const std::string ID = "VoiceRelease";
+	std::string name = "Voice release";
+	std::string unitName = " ms";
+	float minValue = 10.f;
+	float maxValue = 2000.f;
+	float defaultValue = 300.f;
+}paramVoiceRelease;
+
+class ResonatorVoiceParameter
+{
+public:
+	int addParameter(std::vector<std::unique_ptr<RangedAudioParameter>>& paramVector);
+};
+
+class ResonatorVoiceBank
+{
+public:
+    ResonatorVoiceBank();
+    void prepareParameter(std::unique_ptr<AudioProcessorValueTreeState>& vts);
+    void prepareToPlay(double sampleRate, int maxControlPoints, int nrofchannels);
+    void reset();
+
+    bool isActive() const { return *m_keyTrackOn > 0.5f; };
+
+    void handleMidiEvent(const MidiMessage& message);
+    /**
+     * advances the voice envelopes by nrofsamples and stores the voice
+     * coefficients and gains of this sub block. Must be called in order for
+     * every control point of the block before the channels are processed.
+     */
+    void processControlPoint(int controlPoint, int nrofsamples);
+    /**
+     * runs all voices on one channel (in place). data points to the sub block
+     * of the given control point.
+     */
+    void processChannel(int channel, int controlPoint, float* data, int nrofsamples);
+    // clears the states of one channel (after an instability)
+    void resetChannel(int channel);
+
+private:
+    // coefficients and gains of all voices for one sub block
+    struct VoiceSnapshot
+    {
+        float b0[MAX_RESONATOR_VOICES];
+        float a1[MAX_RESONATOR_VOICES];
+        float a2[MAX_RESONATOR_VOICES];
+        float gainStart[MAX_RESONATOR_VOICES];
+        float gainEnd[MAX_RESONATOR_VOICES];
+        uint32 resetMask;
+    };
+    // states of all voices of one channel
+    struct ChannelState
+    {
+        float y1[MAX_RESONATOR_VOICES];
+        float y2[MAX_RESONATOR_VOICES];
+        float x1;
+        float x2;
+    };
+
+    double m_fs;
+    std::vector<VoiceSnapshot> m_snapshots;
+    std::vector<ChannelState> m_states;
+
+    // voice pool (control data, changed at control rate only)
+    int m_note[MAX_RESONATOR_VOICES];
+    bool m_gateOn[MAX_RESONATOR_VOICES];
+    float m_velocity[MAX_RESONATOR_VOICES];
+    float m_gain[MAX_RESONATOR_VOICES];
+    float m_cosTheta[MAX_RESONATOR_VOICES];
+    uint32 m_age[MAX_RESONATOR_VOICES];
+    uint32 m_ageCounter;
+    uint32 m_pendingReset;
+
+    std::atomic<float>* m_keyTrackOn;
+    std::atomic<float>* m_voiceRadius;
+    std::atomic<float>* m_voiceRelease;
+
+    void noteOn(int note, float velocity);
+    void noteOff(int note);
+    void allNotesOff();
+    int findFreeVoice();
+};
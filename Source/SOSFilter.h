@@ -14,23 +14,22 @@
 */
 /* ToDO:
 	1) non lienarities with different Forms (clip, tanh)
-	2) In terms of complexitiy it would be better to decide for NL processing outside by calling different functions
-	   processDataNL and processDataTVNL should be designed
-	3) Think about SSE
+	2) Think about SSE
 //*/
 
 #pragma once
 #include <vector>
+#include <cmath>
 template <class T> class SOSFilter
 {
 public:
     SOSFilter(){m_b0 = 1.0; m_b1 = 0.0; m_b2 = 0.0; m_a1 = 0.0; m_a2 = 0.0;
         m_b0Old = 1.0; m_b1Old = 0.0; m_b2Old = 0.0; m_a1Old = 0.0; m_a2Old = 0.0;
-   	    m_newCoeffs = false; setXFadeSamples(30); m_useNL = true; m_clipVal = 20.f;
+   	    m_newCoeffs = false; setXFadeSamples(30); m_useNL = false; m_clipVal = 20.f;
         reset(); };
     SOSFilter(T b0, T b1, T b2, T a1, T a2){m_b0 = b0; m_b1 = b1; m_b2 = b2; m_a1 = a1; m_a2 = a2;
         m_b0Old = b0; m_b1Old = b1; m_b2Old = b2; m_a1Old = a1; m_a2Old = a2;
-   	    m_newCoeffs = false; setXFadeSamples(30); m_useNL = true; m_clipVal = 20.f;
+   	    m_newCoeffs = false; setXFadeSamples(30); m_useNL = false; m_clipVal = 20.f;
         reset(); };
 
     void reset(){
@@ -48,86 +47,34 @@ public:
 	    if (in.size() != out.size())
 		    return -1;
 
-	    for (unsigned int kk = 0; kk < in.size(); kk++)
-	    {
-            T curSample = in[kk];
-			out[kk] = m_b0*curSample + m_b1*m_stateb1 + m_b2*m_stateb2 - m_a1*m_statea1 - m_a2*m_statea2;
-			// non linearities for instable filters
-			if (m_useNL)
-			{
-				
-				if (out[kk]>m_clipVal)
-					out[kk] = m_clipVal;
-				if (out[kk]<-m_clipVal)
-					out[kk] = -m_clipVal;
-			}
-			m_statea2 = m_statea1;
-            m_statea1 = out[kk];
-            m_stateb2 = m_stateb1;
-            m_stateb1 = curSample;
-    	}
+	    return processData(in.data(), out.data(), static_cast<int>(in.size()));
+    };
+	// pointer version, in and out may be the same memory (in place processing of sub blocks)
+	int processData(const T* in, T* out, int nrofsamples)
+    {
+		// the decision for the non linearity is made once per block, not per sample
+		if (m_useNL)
+			return processDataTI<true>(in, out, nrofsamples);
 
-	    return 0;
+		return processDataTI<false>(in, out, nrofsamples);
     };
 	int processDataTV(std::vector<T>& in, std::vector<T>& out)
     {
 	    if (in.size() != out.size())
 		    return -1;
 
+	    return processDataTV(in.data(), out.data(), static_cast<int>(in.size()));
+    }
+	int processDataTV(const T* in, T* out, int nrofsamples)
+    {
 	    if (m_newCoeffs == false)
-	    {
-		    processData(in, out);
-	    }
-	    else // TV cross fade audio
-	    {
-		    for (unsigned int kk = 0; kk < in.size(); kk++)
-		    {
-			    T newOut = 0.0;
-			    T oldOut = 0.0;
-                T curSample = in[kk];
-			    newOut = m_b0*curSample + m_b1*m_stateb1 + m_b2*m_stateb2 ;
-                oldOut = m_b0Old*curSample + m_b1Old*m_stateb1 + m_b2Old*m_stateb2 ;
-    			newOut -= (m_a1*m_statea1 + m_a2*m_statea2);
-    			oldOut -= (m_a1Old*m_statea1Old + m_a2Old*m_statea2Old);
-
-				// non linearities for instable filters
-				if (m_useNL)
-				{
-
-					if (newOut>m_clipVal)
-						newOut = m_clipVal;
-					if (newOut<-m_clipVal)
-						newOut = -m_clipVal;
-
-					if (oldOut>m_clipVal)
-						oldOut = m_clipVal;
-					if (oldOut<-m_clipVal)
-						oldOut = -m_clipVal;
-
-				}
-
-                m_statea2 = m_statea1;
-                m_statea1 = newOut;
-                m_statea2Old = m_statea1Old;
-                m_statea1Old = oldOut;
-                m_stateb2 = m_stateb1;
-                m_stateb1 = curSample;
-			    if (m_xFadeCounter < m_xFadeTimeSamples)
-			    {
-				    out[kk] = (1.0 - m_CrossGain) * oldOut + m_CrossGain * newOut;
-				    m_CrossGain += m_StepSize;
-				    m_xFadeCounter++;
-			    }
-			    else
-			    {
-				    out[kk] = newOut;
-				    m_newCoeffs = false;
-			    }
-		}
-		
-	}
+		    return processData(in, out, nrofsamples);
+
+		// TV cross fade audio
+		if (m_useNL)
+			return processDataXFade<true>(in, out, nrofsamples);
 
-	return 0;        
+		return processDataXFade<false>(in, out, nrofsamples);
     }
 	int setXFadeSamples(int nrofsamples)
     {
@@ -139,7 +86,79 @@ public:
     }
 
 	void setClipValue (T clipval){m_clipVal = clipval;};
+	// hard clipping of the recursive part, off by default (the processor switches it on without pole protection)
+	void setUseNL (bool useNL){m_useNL = useNL;};
+
+	// true if all recursive states are finite and below maxVal (NaN fails every comparison)
+	bool isStateHealthy(T maxVal) const
+	{
+		return std::abs(m_statea1) < maxVal && std::abs(m_statea2) < maxVal
+			&& std::abs(m_statea1Old) < maxVal && std::abs(m_statea2Old) < maxVal
+			&& std::abs(m_stateb1) < maxVal && std::abs(m_stateb2) < maxVal;
+	};
+	// clears all states and finishes a running cross fade, used after an instability
+	void recover(){ reset(); m_stateb1 = 0.0; m_stateb2 = 0.0; m_newCoeffs = false; };
 private:
+	inline T clip(T val) const
+	{
+		return val > m_clipVal ? m_clipVal : (val < -m_clipVal ? -m_clipVal : val);
+	};
+	template <bool useNL> int processDataTI(const T* in, T* out, int nrofsamples)
+	{
+	    for (int kk = 0; kk < nrofsamples; kk++)
+	    {
+            T curSample = in[kk];
+			T outSample = m_b0*curSample + m_b1*m_stateb1 + m_b2*m_stateb2 - m_a1*m_statea1 - m_a2*m_statea2;
+			// non linearities for instable filters
+			if (useNL)
+				outSample = clip(outSample);
+
+			out[kk] = outSample;
+			m_statea2 = m_statea1;
+            m_statea1 = outSample;
+            m_stateb2 = m_stateb1;
+            m_stateb1 = curSample;
+    	}
+	    return 0;
+	};
+	template <bool useNL> int processDataXFade(const T* in, T* out, int nrofsamples)
+	{
+		for (int kk = 0; kk < nrofsamples; kk++)
+		{
+			T curSample = in[kk];
+			T newOut = m_b0*curSample + m_b1*m_stateb1 + m_b2*m_stateb2 ;
+			T oldOut = m_b0Old*curSample + m_b1Old*m_stateb1 + m_b2Old*m_stateb2 ;
+			newOut -= (m_a1*m_statea1 + m_a2*m_statea2);
+			oldOut -= (m_a1Old*m_statea1Old + m_a2Old*m_statea2Old);
+
+			// non linearities for instable filters
+			if (useNL)
+			{
+				newOut = clip(newOut);
+				oldOut = clip(oldOut);
+			}
+
+			m_statea2 = m_statea1;
+			m_statea1 = newOut;
+			m_statea2Old = m_statea1Old;
+			m_statea1Old = oldOut;
+			m_stateb2 = m_stateb1;
+			m_stateb1 = curSample;
+			if (m_xFadeCounter < m_xFadeTimeSamples)
+			{
+				out[kk] = (1.0 - m_CrossGain) * oldOut + m_CrossGain * newOut;
+				m_CrossGain += m_StepSize;
+				m_xFadeCounter++;
+			}
+			else
+			{
+				out[kk] = newOut;
+				m_newCoeffs = false;
+			}
+		}
+		return 0;
+	};
+
     T m_b0,m_b1,m_b2;
     T m_a1,m_a2;
 
@@ -40,6 +40,12 @@
 #define BUTTON_HEIGHT 25
 #define BUTTON_PADDING 5
 
+// zoom of the x axis: mouse wheel step and the smallest visible part of the full range
+#define ZOOM_WHEEL_FACTOR 0.8
+#define ZOOM_MIN_RANGE_FRACTION 0.002
+// lowest frequency on the log axis
+#define LOG_AXIS_MIN_VALUE 10.0
+
 #define AXIS_DESCRIPTION_SPACE_HEIGHT (AXIS_TEXT_HEIGHT + AXIS_DESCRIPTION_HEIGHT)
 #define AXIS_DESCRIPTION_SPACE_WIDTH (AXIS_TEXT_WIDTH + AXIS_DESCRIPTION_HEIGHT)
 
@@ -59,7 +65,10 @@ public:
         m_minValueY(0.0), m_maxValueY(10.0), m_valueStepY(1.0),
         m_axisLabelX("x-axis"), m_axisLabelY("y-axis"), m_axisLabelLogX("x-axis (log)"),
         m_withAxisDescriotion(true), m_axisStyle(axisStyles::rect),
-        m_isLogScaleActivated(false)
+        m_pathIsValid(false), m_staticLayerIsValid(false),
+        m_isLogScaleActivated(false), m_withZoom(false),
+        m_fullMinValueX(0.0), m_fullMaxValueX(10.0), m_visibleMinValueX(0.0), m_visibleMaxValueX(10.0),
+        m_dragStartMinValueX(0.0), m_dragStartMaxValueX(10.0)
     {
         // In your constructor, you should add any child components, and
         // initialise any special settings that your component needs.
@@ -72,26 +81,25 @@ public:
     {
     }
 
-    void setData(std::vector<float> xValues, std::vector<float> yValues)
+    void setData(const std::vector<float>& xValues, const std::vector<float>& yValues)
     {
         if (xValues.size() != yValues.size())
             return;
 
-        if (m_withAutoScale)
-        {
-            float maxYValue = *std::max_element(yValues.begin(), yValues.end());
-            int maxSteps = static_cast<int>(maxYValue / m_valueStepY) + 1;
-            m_maxValueY = maxSteps * m_valueStepY;
-
-            float minYValue = *std::min_element(yValues.begin(), yValues.end());
-            int minSteps = static_cast<int>(minYValue / m_valueStepY) -1;
-            m_minValueY = minSteps * m_valueStepY;
-        }
+        // no allocation if the size stays the same
+        m_xValues.assign(xValues.begin(), xValues.end());
+        m_yValues.assign(yValues.begin(), yValues.end());
+        dataChanged();
+    }
 
-        m_xValues = xValues;
-        m_yValues = yValues;
+    void setData(std::vector<float>&& xValues, std::vector<float>&& yValues)
+    {
+        if (xValues.size() != yValues.size())
+            return;
 
-        scaleValuesToPath();
+        m_xValues = std::move(xValues);
+        m_yValues = std::move(yValues);
+        dataChanged();
     }
 
     void resized() override
@@ -105,17 +113,127 @@ public:
         m_endPosY = r.getY() + r.getHeight() - PADDING - AXIS_DESCRIPTION_SPACE_HEIGHT;
 
         m_logButton.setBounds(r.removeFromBottom(BUTTON_HEIGHT).removeFromLeft(BUTTON_WIDTH).reduced(BUTTON_PADDING));
+        axisChanged();
     }
 
     void paint (Graphics& g) override
     {
-        /* This demo code just fills the component's background and
-           draws some placeholder text to get you started.
+        // background, axes and labels come from the cached image, only the data path is stroked
+        paintStaticLayerCached(g);
+        paintOverlay(g);
+
+        if (!m_pathIsValid)
+        {
+            scaleValuesToPath();
+            m_pathIsValid = true;
+        }
+
+        g.setColour(PlotColour);
+        if (!m_valuesToPlot.isEmpty())
+            g.strokePath(m_valuesToPlot, PathStrokeType(1.0f));
+    }
+
+    // x axis range in linear values (e.g. Hz), also for the log axis
+    void setFullRangeX(double minValue, double maxValue)
+    {
+        m_fullMinValueX = minValue;
+        m_fullMaxValueX = maxValue;
+        m_visibleMinValueX = minValue;
+        m_visibleMaxValueX = maxValue;
+        updateAxisRangeX();
+    }
+
+    void setVisibleRangeX(double minValue, double maxValue)
+    {
+        // limited to the full range, keeps the width while panning at the borders
+        double minAxis = toAxisValueX(m_fullMinValueX);
+        double maxAxis = toAxisValueX(m_fullMaxValueX);
+        double minWidth = ZOOM_MIN_RANGE_FRACTION * (maxAxis - minAxis);
+        double newMin = toAxisValueX(minValue);
+        double newMax = toAxisValueX(maxValue);
+        double width = jlimit(minWidth, maxAxis - minAxis, newMax - newMin);
+        newMin = jlimit(minAxis, maxAxis - width, newMin);
+
+        m_visibleMinValueX = fromAxisValueX(newMin);
+        m_visibleMaxValueX = fromAxisValueX(newMin + width);
+        if (newMin <= minAxis)
+            m_visibleMinValueX = m_fullMinValueX;
+        if (newMin + width >= maxAxis)
+            m_visibleMaxValueX = m_fullMaxValueX;
+        updateAxisRangeX();
+    }
+
+    double getVisibleMinX() const { return m_visibleMinValueX; };
+    double getVisibleMaxX() const { return m_visibleMaxValueX; };
+
+    bool isLogScaleActivated() const { return m_isLogScaleActivated; };
+    void setLogScale(bool isLog)
+    {
+        if (isLog == m_isLogScaleActivated)
+            return;
 
-           You should replace everything in this method with your own
-           drawing code..
-        */
+        m_isLogScaleActivated = isLog;
+        m_logButton.setButtonText(isLog ? "log" : "lin");
+        // the hidden low end of the log axis becomes visible again
+        setVisibleRangeX(isLog ? m_visibleMinValueX : (m_visibleMinValueX <= LOG_AXIS_MIN_VALUE ? m_fullMinValueX : m_visibleMinValueX),
+            m_visibleMaxValueX);
+    }
+
+    // called after a zoom, pan or lin/log change by the user
+    std::function<void()> xAxisChanged;
 
+    void mouseWheelMove(const MouseEvent& event, const MouseWheelDetails& wheel) override
+    {
+        if (!m_withZoom)
+        {
+            Component::mouseWheelMove(event, wheel);
+            return;
+        }
+        // zoom around the mouse position
+        double factor = std::pow(ZOOM_WHEEL_FACTOR, (wheel.isReversed ? -wheel.deltaY : wheel.deltaY) * 4.0);
+        double anchor = scaleToValueX(event.x);
+        double newMin = anchor - (anchor - m_minValueX) * factor;
+        double newMax = anchor + (m_maxValueX - anchor) * factor;
+        setVisibleRangeX(fromAxisValueX(newMin), fromAxisValueX(newMax));
+        userChangedAxisX();
+    }
+
+    void mouseDown(const MouseEvent& event) override
+    {
+        ignoreUnused(event);
+        m_dragStartMinValueX = m_minValueX;
+        m_dragStartMaxValueX = m_maxValueX;
+    }
+
+    void mouseDrag(const MouseEvent& event) override
+    {
+        if (!m_withZoom || m_endPosX <= m_startPosX)
+            return;
+
+        double shift = -event.getDistanceFromDragStartX() * (m_dragStartMaxValueX - m_dragStartMinValueX)
+            / (m_endPosX - m_startPosX);
+        setVisibleRangeX(fromAxisValueX(m_dragStartMinValueX + shift), fromAxisValueX(m_dragStartMaxValueX + shift));
+        userChangedAxisX();
+    }
+
+    void mouseDoubleClick(const MouseEvent& event) override
+    {
+        ignoreUnused(event);
+        if (!m_withZoom)
+            return;
+
+        setVisibleRangeX(m_fullMinValueX, m_fullMaxValueX);
+        userChangedAxisX();
+    }
+
+protected:
+
+    // drawn on top of the static layer and below the data path (e.g. a live spectrum)
+    virtual void paintOverlay(Graphics& g) { ignoreUnused(g); };
+
+    // everything that only depends on size and axis settings, drawn once into the static layer
+    virtual void paintStaticLayer(Graphics& g)
+    {
         g.fillAll (getLookAndFeel().findColour (ResizableWindow::backgroundColourId));   // clear the background
         
         g.setColour(BorderColour);
@@ -131,31 +249,108 @@ public:
                 paintAxis(g);
         }
 
-        g.setColour(PlotColour);
-        scaleValuesToPath();
-        if (!m_valuesToPlot.isEmpty())
-            g.strokePath(m_valuesToPlot, PathStrokeType(1.0f));
-        
         if (m_withAxisDescriotion)
             addAxisDescription(g);
     }
 
-protected:
+    void paintStaticLayerCached(Graphics& g)
+    {
+        // rendered in physical pixels, so it stays sharp on high dpi displays
+        auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+        auto width = roundToInt(getWidth() * scale);
+        auto height = roundToInt(getHeight() * scale);
+        if (width <= 0 || height <= 0)
+            return;
+
+        if (!m_staticLayerIsValid || m_staticLayer.getWidth() != width || m_staticLayer.getHeight() != height)
+        {
+            m_staticLayer = Image(Image::ARGB, width, height, true);
+            Graphics imageGraphics(m_staticLayer);
+            imageGraphics.addTransform(AffineTransform::scale(scale));
+            paintStaticLayer(imageGraphics);
+            m_staticLayerIsValid = true;
+        }
+        g.drawImage(m_staticLayer, getLocalBounds().toFloat());
+    }
+
+    // call after changing the axis range, scaling or size
+    void axisChanged()
+    {
+        m_staticLayerIsValid = false;
+        m_pathIsValid = false;
+        repaint();
+    }
+
+    void dataChanged()
+    {
+        if (m_withAutoScale && !m_yValues.empty())
+        {
+            auto minMaxY = std::minmax_element(m_yValues.begin(), m_yValues.end());
+            double oldMin = m_minValueY;
+            double oldMax = m_maxValueY;
+            if (m_withAutoStepY)
+                m_valueStepY = getNiceStep(jmax((*minMaxY.second - *minMaxY.first) / 4, 0.01f));
+
+            int maxSteps = static_cast<int>(*minMaxY.second / m_valueStepY) + 1;
+            m_maxValueY = maxSteps * m_valueStepY;
+
+            int minSteps = static_cast<int>(*minMaxY.first / m_valueStepY) -1;
+            m_minValueY = minSteps * m_valueStepY;
+
+            if (oldMin != m_minValueY || oldMax != m_maxValueY)
+                m_staticLayerIsValid = false;
+        }
+        m_pathIsValid = false;
+        repaint();
+    }
 
     void changeFreqAxisScale()
     {
-        m_isLogScaleActivated = !m_isLogScaleActivated;
-        if(m_isLogScaleActivated){
-            m_logButton.setButtonText("log");
-            m_maxValueX = log10(m_maxValueX);
-            m_minValueX = 1.0;
-        } else {
-            m_logButton.setButtonText("lin");
-            m_maxValueX = round(pow(10, m_maxValueX));
-            m_minValueX = 0.0;
+        setLogScale(!m_isLogScaleActivated);
+        userChangedAxisX();
+    }
+
+    void userChangedAxisX()
+    {
+        if (xAxisChanged != nullptr)
+            xAxisChanged();
+    }
+
+    double toAxisValueX(double value) const
+    {
+        return m_isLogScaleActivated ? log10(jmax(value, LOG_AXIS_MIN_VALUE)) : value;
+    }
+
+    double fromAxisValueX(double axisValue) const
+    {
+        return m_isLogScaleActivated ? pow(10.0, axisValue) : axisValue;
+    }
+
+    // axis values and tick step from the visible range
+    void updateAxisRangeX()
+    {
+        m_minValueX = toAxisValueX(m_visibleMinValueX);
+        m_maxValueX = toAxisValueX(m_visibleMaxValueX);
+        if (!m_isLogScaleActivated && m_maxValueX > m_minValueX)
+        {
+            // about 6 ticks
+            m_valueStepX = getNiceStep((m_maxValueX - m_minValueX) / 6);
         }
+        axisChanged();
+    }
 
-        repaint();
+    // 1, 2, 2.5 or 5 times a power of ten, not smaller than roughStep
+    static double getNiceStep(double roughStep)
+    {
+        if (!(roughStep > 1e-6))
+            return 1e-6;
+
+        double decade = pow(10.0, floor(log10(roughStep)));
+        for (double mantissa : { 1.0, 2.0, 2.5, 5.0 })
+            if (mantissa * decade >= roughStep)
+                return mantissa * decade;
+
+        return 10.0 * decade;
     }
 
     void paintAxis(Graphics& g)
@@ -194,29 +389,29 @@ protected:
     {
         g.setFont(FontSize_small);
      
-        // X axis
-        double valueX = m_minValueX;
+        // X axis, decades from below the visible range
+        double valueX = floor(m_minValueX);
+        // zoomed into less than a decade, the small ticks get labels too
+        bool labelAllTicks = m_maxValueX - m_minValueX < 1.0;
 
-        String xTickText;
         while (valueX <= m_maxValueX)
         {
-            int posX = scaleToCoordsX(valueX);
-            g.drawLine(posX, m_startPosY, posX, m_endPosY, LINEWIDH_MEDIUM);
-            int xTick = int(pow(10,valueX));
-            
-            if (xTick > 1000) { xTickText = String(xTick / 1000) + "k"; }
-            else { xTickText = String(xTick); }
-
-            g.drawText(xTickText, posX - AXIS_TEXT_WIDTH / 2,
-                m_endPosY , AXIS_TEXT_WIDTH, AXIS_TEXT_HEIGHT, 
-                Justification::centred);
+            if (valueX >= m_minValueX)
+            {
+                int posX = scaleToCoordsX(valueX);
+                g.drawLine(posX, m_startPosY, posX, m_endPosY, LINEWIDH_MEDIUM);
+                addAxisTickTextLog(g, posX, pow(10, valueX));
+            }
 
-            for(int kk = 1U; kk < 10;++kk)
+            for(int kk = 2; kk < 10;++kk)
             {
-                double helpValX = valueX + log10(10 * kk) - 1.0;
+                double helpValX = valueX + log10(kk);
                 if (helpValX > m_maxValueX) break;
+                if (helpValX < m_minValueX) continue;
                 int helpPosX = scaleToCoordsX(helpValX);
                 g.drawLine(helpPosX, m_startPosY, helpPosX, m_endPosY, LINEWIDH_SMALL);
+                if (labelAllTicks)
+                    addAxisTickTextLog(g, helpPosX, kk * pow(10, valueX));
             }
 
             valueX += 1.0;
@@ -238,21 +433,32 @@ protected:
         }
     }
 
+    void addAxisTickTextLog(Graphics& g, int posX, double value)
+    {
+        int xTick = roundToInt(value);
+        String xTickText;
+        if (xTick >= 1000) { xTickText = String(xTick / 1000.0, xTick % 1000 == 0 ? 0 : 1) + "k"; }
+        else { xTickText = String(xTick); }
+
+        g.drawText(xTickText, posX - AXIS_TEXT_WIDTH / 2,
+            m_endPosY , AXIS_TEXT_WIDTH, AXIS_TEXT_HEIGHT, 
+            Justification::centred);
+    }
     
     void addAxisTicksRect(Graphics& g)
     {
         g.setFont(FontSize_small);
      
-        // X axis
-        float valueX = m_minValueX;
-        while (valueX <= m_maxValueX)
+        // X axis, on multiples of the step (zoomed ranges do not start on a tick)
+        double valueX = ceil(m_minValueX / m_valueStepX - 0.001) * m_valueStepX;
+        while (valueX <= m_maxValueX + 0.001 * m_valueStepX)
         {
             int posX = scaleToCoordsX(valueX);
             if(valueX == 0)
                 g.drawLine(posX, m_startPosY, posX, m_endPosY, LINEWIDH_MEDIUM);
             else
                 g.drawLine(posX, m_startPosY, posX, m_endPosY, LINEWIDH_SMALL);
-            g.drawText(String(valueX/1000), posX - AXIS_TEXT_WIDTH / 2,
+            g.drawText(String(valueX*m_tickLabelScaleX), posX - AXIS_TEXT_WIDTH / 2,
                 m_endPosY , AXIS_TEXT_WIDTH, AXIS_TEXT_HEIGHT, 
                 Justification::centred);
             valueX += m_valueStepX;
@@ -352,34 +558,68 @@ protected:
         return  static_cast<int> (scaleValue * (m_endPosY - m_startPosY)) + m_startPosY;
     }
 
+    // more points than pixel columns are reduced to first, min, max and last value per column
     void scaleValuesToPath()
     {
         m_valuesToPlot.clear();
-        if (m_isLogScaleActivated)
+        m_valuesToPlot.preallocateSpace(4 * 3 * (m_endPosX - m_startPosX + 2));
+
+        int column = 0;
+        int firstY = 0, minY = 0, maxY = 0, lastY = 0;
+        bool minFirst = true;
+        for (auto kk = 0U; kk < m_xValues.size(); ++kk)
         {
-            for (auto kk = 0U; kk < m_xValues.size(); ++kk)
+            float xValue = m_isLogScaleActivated ? log10(m_xValues[kk]) : m_xValues[kk];
+            int xPos = scaleToCoordsX(xValue);
+            int yPos = scaleToCoordsY(m_yValues[kk]);
+            if (kk == 0)
             {
-                int xPos = scaleToCoordsX(log10(m_xValues[kk]));
-                int yPos = scaleToCoordsY(m_yValues[kk]);
-                if (kk == 0)
-                    m_valuesToPlot.startNewSubPath(xPos, yPos);
-                else
-                    m_valuesToPlot.lineTo(Point<float>(xPos, yPos));
+                m_valuesToPlot.startNewSubPath(xPos, yPos);
             }
-        } else {
-            for (auto kk = 0U; kk < m_xValues.size(); ++kk)
+            else if (xPos != column)
+            {
+                addColumnToPath(column, firstY, minY, maxY, lastY, minFirst);
+            }
+            else
             {
-                int xPos = scaleToCoordsX(m_xValues[kk]);
-                int yPos = scaleToCoordsY(m_yValues[kk]);
-                if (kk == 0)
-                    m_valuesToPlot.startNewSubPath(xPos, yPos);
-                else
-                    m_valuesToPlot.lineTo(Point<float>(xPos, yPos));
+                if (yPos < minY)
+                {
+                    minY = yPos;
+                    minFirst = false;
+                }
+                if (yPos > maxY)
+                {
+                    maxY = yPos;
+                    minFirst = true;
+                }
+                lastY = yPos;
+                continue;
             }
+            column = xPos;
+            firstY = minY = maxY = lastY = yPos;
+            minFirst = true;
         }
+        if (!m_xValues.empty())
+            addColumnToPath(column, firstY, minY, maxY, lastY, minFirst);
+    }
+
+    void addColumnToPath(int column, int firstY, int minY, int maxY, int lastY, bool minFirst)
+    {
+        m_valuesToPlot.lineTo(column, firstY);
+        if (minY != maxY)
+        {
+            m_valuesToPlot.lineTo(column, minFirst ? minY : maxY);
+            m_valuesToPlot.lineTo(column, minFirst ? maxY : minY);
+        }
+        if (lastY != firstY)
+            m_valuesToPlot.lineTo(column, lastY);
     }
 
     bool m_withAutoScale;
+    // the auto scale also chooses the tick step
+    bool m_withAutoStepY = false;
+    // x tick labels of the rect style are valueX * m_tickLabelScaleX (default: Hz shown in kHz)
+    double m_tickLabelScaleX = 0.001;
 
     Font m_font;
 
@@ -412,10 +652,23 @@ protected:
 
     // values to plot 
     Path m_valuesToPlot;
+    bool m_pathIsValid;
+
+    Image m_staticLayer;
+    bool m_staticLayerIsValid;
 
     TextButton m_logButton;
     bool m_isLogScaleActivated;
 
+    // zoom and pan of the x axis with mouse wheel and drag, double click shows the full range
+    bool m_withZoom;
+    double m_fullMinValueX;
+    double m_fullMaxValueX;
+    double m_visibleMinValueX;
+    double m_visibleMaxValueX;
+    double m_dragStartMinValueX;
+    double m_dragStartMaxValueX;
+
 private:
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ScaledPlot)
 };
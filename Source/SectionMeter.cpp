@@ -0,0 +1,175 @@
+/*
+  ==============================================================================
+    SectionMeter.cpp
+
+    Authors:    agent
+
+    SPDX-License-Identifier: BSD-3-Clause
+ ==============================================================================
+*/
+
+#include "SectionMeter.h"
+#include "FastMath.h"
+#include "TransferFunLookAndFeel.h"
+
+SectionMeter::SectionMeter()
+:m_fs(48000.f),m_active(false),m_taps(nullptr),m_nrofTapChannels(0)
+{
+    prepareToPlay(m_fs, 2);
+}
+
+void SectionMeter::prepareToPlay(float samplerate, int nrofchannels)
+{
+    m_fs = samplerate;
+    m_nrofTapChannels = jmax(1, nrofchannels);
+    m_tapMemory.allocate(static_cast<size_t>(m_nrofTapChannels) * sizeof(ChannelTaps) + SECTION_TAP_ALIGNMENT, false);
+    auto address = reinterpret_cast<uintptr_t>(m_tapMemory.get());
+    m_taps = reinterpret_cast<ChannelTaps*>((address + SECTION_TAP_ALIGNMENT - 1) & ~static_cast<uintptr_t>(SECTION_TAP_ALIGNMENT - 1));
+    for (auto channel = 0; channel < m_nrofTapChannels; ++channel)
+        new (m_taps + channel) ChannelTaps();
+    for (auto section = 0; section < MAX_POLE_INSTANCES; ++section)
+    {
+        m_meanSquare[section] = 0.f;
+        m_peakState[section] = 0.f;
+        m_rms[section] = 0.f;
+        m_peak[section] = 0.f;
+        m_clipCount[section] = 0;
+    }
+}
+
+void SectionMeter::analyseBlock(int nrofchannels, int nrofsamples)
+{
+    nrofchannels = jmin(nrofchannels, m_nrofTapChannels);
+    if (nrofchannels <= 0 || nrofsamples <= 0)
+        return;
+
+    // block wise ballistics, the same time constants as SimpleMeter
+    double blockTime_ms = 1000.0 * nrofsamples / m_fs;
+    float alphaAttack = static_cast<float>(exp(-blockTime_ms / SECTION_RMS_ATTACK_MS));
+    float alphaRelease = static_cast<float>(exp(-blockTime_ms / SECTION_RMS_RELEASE_MS));
+    float peakRelease = static_cast<float>(pow(10.0, -0.05 * SECTION_PEAK_RELEASE_DB_PER_S * blockTime_ms * 0.001));
+
+    for (auto section = 0; section < MAX_POLE_INSTANCES; ++section)
+    {
+        float peak = 0.f;
+        float sumSquares = 0.f;
+        int clipped = 0;
+        for (auto channel = 0; channel < nrofchannels; ++channel)
+        {
+            Tap& t = m_taps[channel].section[section];
+            peak = jmax(peak, t.peak);
+            sumSquares += t.sumSquares;
+            clipped += t.clipped;
+            t = Tap();
+        }
+
+        float meanSquare = sumSquares / (nrofchannels * nrofsamples);
+        // NaN and Inf (an instable section) fail the comparison
+        if (!(meanSquare < SECTION_MAX_LEVEL * SECTION_MAX_LEVEL))
+            meanSquare = SECTION_MAX_LEVEL * SECTION_MAX_LEVEL;
+        if (!(peak < SECTION_MAX_LEVEL))
+            peak = SECTION_MAX_LEVEL;
+
+        float alpha = meanSquare > m_meanSquare[section] ? alphaAttack : alphaRelease;
+        m_meanSquare[section] = alpha * m_meanSquare[section] + (1.f - alpha) * meanSquare;
+        m_peakState[section] = jmax(peak, m_peakState[section] * peakRelease);
+
+        m_rms[section] = std::sqrt(m_meanSquare[section]);
+        m_peak[section] = m_peakState[section];
+        if (clipped > 0)
+            m_clipCount[section] += static_cast<uint32>(clipped);
+    }
+}
+
+SectionMeterComponent::SectionMeterComponent(SectionMeter& meter, int section)
+:m_meter(meter),m_section(section),m_rmsPixels(0.f),m_peakPixels(0.f),
+m_clipCount(0),m_clipTime_ms(0),m_clipIsShown(false)
+{
+    setOpaque(true);
+}
+
+void SectionMeterComponent::paint(Graphics& g)
+{
+    g.fillAll(getLookAndFeel().findColour(ResizableWindow::backgroundColourId));
+
+    g.setColour(JadeGray.darker(0.5));
+    g.fillRect(m_barBounds);
+
+    // RMS bar and peak line
+    g.setColour(Colours::green);
+    g.fillRect(m_barBounds.withWidth(m_rmsPixels));
+    g.setColour(Colours::yellow);
+    g.fillRect(m_barBounds.getX() + m_peakPixels - 1.f, m_barBounds.getY(), 2.f, m_barBounds.getHeight());
+
+    // 0 dBFS
+    g.setColour(JadeRed);
+    float clipPixels = levelToPixels(SECTION_CLIP_LEVEL);
+    g.drawVerticalLine(static_cast<int>(m_barBounds.getX() + clipPixels), m_barBounds.getY(), m_barBounds.getBottom());
+
+    g.setColour(m_clipIsShown ? JadeRed : JadeGray.darker(0.5));
+    g.fillEllipse(m_clipBounds);
+
+    g.setColour(BorderColour);
+    g.drawRect(m_barBounds);
+}
+
+void SectionMeterComponent::resized()
+{
+    auto bounds = getLocalBounds().toFloat();
+    float clipSize = jmin(bounds.getHeight(), 10.f);
+    m_clipBounds = bounds.removeFromRight(clipSize).withSizeKeepingCentre(clipSize, clipSize);
+    bounds.removeFromRight(2.f);
+    m_barBounds = bounds.withSizeKeepingCentre(bounds.getWidth(), jmin(bounds.getHeight(), 8.f));
+    m_rmsPixels = m_peakPixels = 0.f;
+}
+
+void SectionMeterComponent::mouseDown(const MouseEvent& e)
+{
+    ignoreUnused(e);
+    m_clipIsShown = false;
+    repaint();
+}
+
+void SectionMeterComponent::updateFromMeter()
+{
+    bool needsRepaint = false;
+
+    float rmsPixels = levelToPixels(m_meter.getRMS(m_section));
+    float peakPixels = levelToPixels(m_meter.getPeak(m_section));
+    if (std::abs(rmsPixels - m_rmsPixels) >= 1.f || std::abs(peakPixels - m_peakPixels) >= 1.f)
+    {
+        m_rmsPixels = rmsPixels;
+        m_peakPixels = peakPixels;
+        needsRepaint = true;
+    }
+
+    uint32 now = Time::getMillisecondCounter();
+    uint32 clipCount = m_meter.getClipCount(m_section);
+    if (clipCount != m_clipCount)
+    {
+        // a smaller count is a reset (prepareToPlay)
+        if (clipCount > m_clipCount)
+        {
+            m_clipTime_ms = now;
+            needsRepaint = needsRepaint || !m_clipIsShown;
+            m_clipIsShown = true;
+        }
+        m_clipCount = clipCount;
+    }
+    else if (m_clipIsShown && now - m_clipTime_ms > SECTION_CLIP_HOLD_MS)
+    {
+        m_clipIsShown = false;
+        needsRepaint = true;
+    }
+
+    if (needsRepaint)
+        repaint();
+}
+
+float SectionMeterComponent::levelToPixels(float level) const
+{
+    float level_dB = fastPowerTodB(level * level + 1e-12f);
+    float norm = (jlimit(SECTION_DISPLAY_MIN_DB, SECTION_DISPLAY_MAX_DB, level_dB) - SECTION_DISPLAY_MIN_DB)
+        / (SECTION_DISPLAY_MAX_DB - SECTION_DISPLAY_MIN_DB);
+    return norm * m_barBounds.getWidth();
+}
@@ -0,0 +1,134 @@
+/*
+  ==============================================================================
+    SectionMeter.h
+
+    Levels inside the filter cascade: peak, RMS and clipped samples after
+    each second order section. The worker threads tap the output of every
+    section per channel and sub-block (tap()), the audio thread combines the
+    channels once per block (analyseBlock()) and publishes the levels in
+    atomics, so the GUI reads them without any lock. The clip counter counts
+    samples above SECTION_CLIP_LEVEL (0 dBFS), which the cascade itself
+    survives in float but the output would not.
+
+    SectionMeterComponent is a small horizontal meter for one section.
+
+    Authors:    agent
+
+    SPDX-License-Identifier: BSD-3-Clause
+ ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <JuceHeader.h>
+#include "PNParameter.h"
+
+#define SECTION_CLIP_LEVEL 1.f
+// levels above are shown as this level (also used for NaN and Inf)
+#define SECTION_MAX_LEVEL 10.f
+#define SECTION_RMS_ATTACK_MS 10.0
+#define SECTION_RMS_RELEASE_MS 300.0
+#define SECTION_PEAK_RELEASE_DB_PER_S 20.0
+// display range of the meter component and the hold time of its clip indicator
+#define SECTION_DISPLAY_MIN_DB -60.f
+#define SECTION_DISPLAY_MAX_DB 20.f
+#define SECTION_CLIP_HOLD_MS 2000
+// cache line, the taps of one channel are aligned to it
+#define SECTION_TAP_ALIGNMENT 64
+
+class SectionMeter
+{
+public:
+    SectionMeter();
+    void prepareToPlay(float samplerate, int nrofchannels);
+
+    // the taps only run while a meter is shown
+    void setActive(bool active) { m_active = active; };
+    bool isActive() const { return m_active.load(); };
+
+    // worker thread of the channel: output of one section for one sub-block
+    void tap(int channel, int section, const float* data, int nrofsamples)
+    {
+        Tap& t = m_taps[channel].section[section];
+        float peak = t.peak;
+        float sumSquares = 0.f;
+        int clipped = 0;
+        for (int kk = 0; kk < nrofsamples; ++kk)
+        {
+            float in = std::abs(data[kk]);
+            peak = jmax(peak, in);
+            sumSquares += in * in;
+            clipped += in > SECTION_CLIP_LEVEL;
+        }
+        t.peak = peak;
+        t.sumSquares += sumSquares;
+        t.clipped += clipped;
+    };
+
+    // audio thread, after all channels of the block are processed
+    void analyseBlock(int nrofchannels, int nrofsamples);
+
+    // any thread
+    float getRMS(int section) const { return m_rms[section].load(); };
+    float getPeak(int section) const { return m_peak[section].load(); };
+    // clipped samples since prepareToPlay
+    uint32 getClipCount(int section) const { return m_clipCount[section].load(); };
+
+private:
+    float m_fs;
+    std::atomic<bool> m_active;
+
+    // per channel and section, written by the worker of the channel only
+    struct Tap
+    {
+        float peak = 0.f;
+        float sumSquares = 0.f;
+        int clipped = 0;
+    };
+    // the workers of neighbouring channels never write to the same cache line
+    struct alignas(SECTION_TAP_ALIGNMENT) ChannelTaps
+    {
+        Tap section[MAX_POLE_INSTANCES];
+    };
+    // HeapBlock only guarantees the malloc alignment, m_taps points into it
+    HeapBlock<char> m_tapMemory;
+    ChannelTaps* m_taps;
+    int m_nrofTapChannels;
+
+    // audio thread
+    float m_meanSquare[MAX_POLE_INSTANCES];
+    float m_peakState[MAX_POLE_INSTANCES];
+
+    std::atomic<float> m_rms[MAX_POLE_INSTANCES];
+    std::atomic<float> m_peak[MAX_POLE_INSTANCES];
+    std::atomic<uint32> m_clipCount[MAX_POLE_INSTANCES];
+};
+
+class SectionMeterComponent : public Component
+{
+public:
+    SectionMeterComponent(SectionMeter& meter, int section);
+    ~SectionMeterComponent(){};
+    void paint(Graphics& g) override;
+    void resized() override;
+    // a click clears the clip indicator
+    void mouseDown(const MouseEvent& e) override;
+
+    // polled once per frame by the GUI, repaints only if a level moved by at least one pixel
+    void updateFromMeter();
+private:
+    SectionMeter& m_meter;
+    int m_section;
+
+    float m_rmsPixels;
+    float m_peakPixels;
+    uint32 m_clipCount;
+    uint32 m_clipTime_ms;
+    bool m_clipIsShown;
+
+    Rectangle<float> m_barBounds;
+    Rectangle<float> m_clipBounds;
+    float levelToPixels(float level) const;
+};
@@ -9,6 +9,7 @@
  ==============================================================================
 */
 #include "SimpleMeter.h"
+#include "FastMath.h"
 
 SimpleMeter::SimpleMeter()
 :m_fs(44100.0),m_blockSize(1024),m_tauAttRMS_ms(10.0),m_tauRelRMS_ms(300.0),m_holdtime_ms(3000.0)
@@ -43,6 +44,8 @@ void SimpleMeter::analyseData (juce::AudioBuffer<float>& data)
         m_peak.resize((totalNrChannels));
         m_peakholdcounter.resize((totalNrChannels));
     }
+    // more channels than meters (e.g. ambisonics): only the first ones are shown
+    totalNrChannels = jmin(totalNrChannels, m_rms.size());
 	for (size_t channel = 0; channel < totalNrChannels; ++channel)
 	{
         auto* channelData = data.getWritePointer (channel);
@@ -113,271 +116,371 @@ int SimpleMeter::getAnalyserData(std::vector<float>& rms, std::vector<float>& pe
 }
 
 
+// meter scale (norm pixels on a 42 x 106 meter)
+static const float normSizeShort = 42.0;
+static const float normSizeLong = 106.0;
+static const float normBorder = 3.0;
+static const float maxvalPeakOrRMS = 6.0;
+static const float redfrom = 0.0;
+static const float yellowfrom = -9.0;
+static const float greenfrom = -60.0;
+static const float rednormpixels = 20.0;
+static const float yellownormpixels = 30.0;
+static const float scalechangePixels = 60.0;
+static const float scale3dbFrom = -12.0;
+static const float peakdisplaywidth = 3.0;
+
 SimpleMeterComponent::SimpleMeterComponent(SimpleMeter &meter)
-:m_scaleFactor(1.f),m_meter(meter),m_displaychannels(2)
+:m_scaleFactor(1.f),m_meter(meter),m_displaychannels(2),m_backgroundIsValid(false)
 {
     m_rms.resize(8);
     m_peak.resize(8);
+    m_rms_dB.resize(8);
+    m_peak_dB.resize(8);
+    m_rmsPixels.resize(8);
+    m_peakPixels.resize(8);
     std::fill(m_rms.begin(), m_rms.end(), 0.0);
     std::fill(m_peak.begin(), m_peak.end(), 0.0);
-
-    startTimer (40);
+    std::fill(m_rms_dB.begin(), m_rms_dB.end(), greenfrom - 1.0);
+    std::fill(m_peak_dB.begin(), m_peak_dB.end(), greenfrom - 1.0);
+    updateGeometry();
 }
-void SimpleMeterComponent::paint(Graphics& g)
+
+void SimpleMeterComponent::updateFromMeter()
 {
-    g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId).darker(0.2));
+    size_t nrofchannels = m_meter.getAnalyserData(m_rms,m_peak);
+    if (nrofchannels != m_displaychannels)
+    {
+        m_displaychannels = nrofchannels;
+        updateGeometry();
+        repaint();
+    }
 
+    for (size_t kk = 0; kk < m_displaychannels && kk < m_rms_dB.size(); kk++)
+    {
+        // peak is an amplitude, rms a power
+        float peaklog = fastPowerTodB(m_peak[kk]*m_peak[kk] + 0.0000000000000000001f);
+        float rmslog = fastPowerTodB(m_rms[kk] + 0.00000000001f); // -110dB
+        float peakPixels = levelToPixels(peaklog);
+        float rmsPixels = levelToPixels(rmslog);
+        if (std::abs(peakPixels - m_peakPixels[kk]) < 1.f && std::abs(rmsPixels - m_rmsPixels[kk]) < 1.f)
+            continue;
+
+        m_peak_dB[kk] = peaklog;
+        m_rms_dB[kk] = rmslog;
+        m_peakPixels[kk] = peakPixels;
+        m_rmsPixels[kk] = rmsPixels;
+        repaint(getChannelBounds(kk));
+    }
+}
+
+void SimpleMeterComponent::updateGeometry()
+{
     int w = getWidth();
     int h = getHeight();
+    auto& geo = m_geometry;
+    geo.r = getLocalBounds();
+    geo.border = normBorder;
+    geo.horizontal = w > h;
+    geo.pixelScale = Component::getApproximateScaleFactorForComponent(this);
+    m_backgroundIsValid = false;
+
+    size_t nrofchannels = jmax(size_t(1), m_displaychannels);
+    if (geo.horizontal)
+    {
+        geo.ScaleFactory = h/normSizeShort;
+        geo.ScaleFactorx = w/normSizeLong;
+        geo.displaySizeNorm = normSizeLong - 2.0*geo.border;
+        geo.border *= geo.ScaleFactorx;
+        geo.r.reduce(geo.border, geo.border);
+        float remindingpixels = normSizeShort*geo.ScaleFactory - (2.0+nrofchannels-1.0)*geo.border;
+        geo.sizeperchn = remindingpixels/nrofchannels;
+    }
+    else
+    {
+        geo.ScaleFactory = h/normSizeLong;
+        geo.ScaleFactorx = w/normSizeShort;
+        geo.displaySizeNorm = normSizeLong - 2.0*geo.border;
+        geo.border *= geo.ScaleFactory;
+        geo.r.reduce(geo.border, geo.border);
+        float remindingpixels = normSizeShort*geo.ScaleFactorx - (2.0+nrofchannels-1.0)*geo.border;
+        geo.sizeperchn = remindingpixels/nrofchannels;
+    }
+    // the next update compares against an impossible position and repaints everything
+    std::fill(m_rmsPixels.begin(), m_rmsPixels.end(), -1000.f);
+    std::fill(m_peakPixels.begin(), m_peakPixels.end(), -1000.f);
+}
 
-    float normSizey = 106.0;
-    float normSizex = 42.0;
-    float border = 3.0;
-    float displaySizeNorm;
-    float maxvalPeakOrRMS = 6.0;
-    float redfrom = 0.0;
-    float yellowfrom = -9.0;
-    float greenfrom = -60.0;
-    float rednormpixels = 20.0;
-    float yellownormpixels = 30.0;
-    // float greennormpixels = 50.0;
-    float scalechangePixels = 60.0;
-    float scale3dbFrom = -12.0;
-    float peakdisplaywidth = 3.0;
-    
-    
+Rectangle<int> SimpleMeterComponent::getChannelBounds(size_t kk) const
+{
+    // the whole length of the meter, the marks can reach into the border
+    auto& geo = m_geometry;
+    float offset = kk*(geo.sizeperchn + geo.border);
+    if (geo.horizontal)
+        return Rectangle<float>(0.f, geo.r.getY() + offset, getWidth(), geo.sizeperchn)
+                .getSmallestIntegerContainer();
+
+    return Rectangle<float>(geo.r.getX() + offset, 0.f, geo.sizeperchn, getHeight())
+            .getSmallestIntegerContainer();
+}
 
-  	auto r = getLocalBounds();
+float SimpleMeterComponent::levelToPixels(float level_dB) const
+{
+    // same slopes as the drawing below: 18 dB on the upper scale, 48 dB on the lower one
+    level_dB = jlimit(greenfrom - 1.f, maxvalPeakOrRMS, level_dB);
+    float normpos;
+    if (level_dB >= scale3dbFrom)
+        normpos = (level_dB - scale3dbFrom)*scalechangePixels/18.0;
+    else
+        normpos = (level_dB - scale3dbFrom)*(m_geometry.displaySizeNorm - scalechangePixels)/48.0;
+
+    float scale = m_geometry.horizontal ? m_geometry.ScaleFactorx : m_geometry.ScaleFactory;
+    return normpos*scale*m_geometry.pixelScale;
+}
 
-    if (w>h) // horizontal meter
+void SimpleMeterComponent::paint(Graphics& g)
+{
+    // rendered in physical pixels, so it stays sharp on high dpi displays
+    auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    int width = roundToInt(getWidth()*scale);
+    int height = roundToInt(getHeight()*scale);
+    if (width <= 0 || height <= 0)
+        return;
+
+    if (!m_backgroundIsValid || m_background.getWidth() != width || m_background.getHeight() != height)
     {
-        normSizex = 106.0;
-        normSizey = 42.0;
-        float ScaleFactory = h/normSizey;
-        float ScaleFactorx = w/normSizex;
-        displaySizeNorm = normSizex- 2.0*border;
-        border *= ScaleFactorx;
-        r.reduce(border, border);
-        float remindingpixels = normSizey*ScaleFactory - (2.0+m_displaychannels-1.0)*border;
-        float heightperchn = remindingpixels/m_displaychannels;
-        for (size_t kk = 0; kk<m_displaychannels; kk++)
+        m_background = Image(Image::RGB, width, height, false);
+        Graphics imageGraphics(m_background);
+        imageGraphics.addTransform(AffineTransform::scale(scale));
+        paintBackground(imageGraphics);
+        m_backgroundIsValid = true;
+    }
+    g.drawImage(m_background, getLocalBounds().toFloat());
+
+    for (size_t kk = 0; kk < m_displaychannels && kk < m_rms_dB.size(); kk++)
+    {
+        if (g.clipRegionIntersects(getChannelBounds(kk)))
+            paintLevels(g, kk);
+    }
+}
+
+void SimpleMeterComponent::paintBackground(Graphics& g)
+{
+    g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId).darker(0.2));
+
+    int w = getWidth();
+    int h = getHeight();
+    auto& geo = m_geometry;
+    auto r = geo.r;
+    float border = geo.border;
+
+    Colour g1 = juce::Colours::green;
+    Colour y1 = juce::Colours::yellow ;
+    Colour r1 = juce::Colours::red;
+    for (size_t kk = 0; kk<m_displaychannels; kk++)
+    {
+        if (geo.horizontal)
         {
-            Colour g1 = juce::Colours::green;
+            float heightperchn = geo.sizeperchn;
             g.setColour(g1.darker(0.95));
             g.fillRect(float (r.getX()),float(r.getY())+ kk*(heightperchn+border),(w-2*border)*0.5  ,heightperchn);
 
-            Colour y1 = juce::Colours::yellow ;
             g.setColour(y1.darker(0.95));
             g.fillRect(float (r.getX())+ (w-2*border)*0.5,float(r.getY())+ kk*(heightperchn+border),(w-2*border)*0.3  ,heightperchn);
 
-            Colour r1 = juce::Colours::red;
             g.setColour(r1.darker(0.95));
             g.fillRect(float (r.getX())+ (w-2*border)*0.8 ,float(r.getY())+ kk*(heightperchn+border),(w-2*border)*0.2,heightperchn);
+        }
+        else
+        {
+            float widthperchn = geo.sizeperchn;
+            g.setColour(r1.darker(0.95));
+            g.fillRect(float (r.getX()) + kk*(widthperchn+border),float(r.getY()),widthperchn,(h-2*border)*0.2);
+
+            g.setColour(y1.darker(0.95));
+            g.fillRect(float (r.getX())+ kk*(widthperchn+border),float(r.getY()) + (h-2*border)*0.2 ,widthperchn,(h-2*border)*0.3);
 
-            // draw Peak 
-            float peaklog = 20*log10(m_peak[kk] + 0.00000000001);
-            if (peaklog >= maxvalPeakOrRMS)
-                peaklog = maxvalPeakOrRMS;
+            g.setColour(g1.darker(0.95));
+            g.fillRect(float (r.getX())+ kk*(widthperchn+border),float(r.getY()) + (h-2*border)*0.5 ,widthperchn,(h-2*border)*0.5);
+        }
+    }
+}
+
+void SimpleMeterComponent::paintLevels(Graphics& g, size_t kk)
+{
+    int w = getWidth();
+    int h = getHeight();
+    auto& geo = m_geometry;
+    auto r = geo.r;
+    float border = geo.border;
+    float displaySizeNorm = geo.displaySizeNorm;
+    float ScaleFactorx = geo.ScaleFactorx;
+    float ScaleFactory = geo.ScaleFactory;
+
+    Colour g1 = juce::Colours::green;
+    Colour y1 = juce::Colours::yellow ;
+    Colour r1 = juce::Colours::red;
+
+    float peaklog = jmin(m_peak_dB[kk], maxvalPeakOrRMS);
+    float rmslog = jmin(m_rms_dB[kk], maxvalPeakOrRMS);
+
+    if (geo.horizontal) // horizontal meter
+    {
+        float heightperchn = geo.sizeperchn;
+        // draw Peak 
+        if (peaklog>greenfrom)
+        {
+            Colour peakcolor;
+            if (peaklog >= redfrom)
+                peakcolor = r1;
+            else 
+            {
+                if (peaklog < redfrom && peaklog > yellowfrom)
+                    peakcolor = y1;
+                else
+                    peakcolor = g1;
+            }    
+            g.setColour(peakcolor.brighter(0.5));
             
-            if (peaklog>greenfrom)
+            if (peaklog > scale3dbFrom)
+            {
+                float normscalepos = scalechangePixels - peakdisplaywidth;
+                float xpos = normscalepos- normscalepos/18.0*(peaklog-6.0)*(-1.0);
+                g.fillRect(float (r.getX())+ (w-2*border)*0.4 + xpos*ScaleFactorx ,float(r.getY())+ kk*(heightperchn+border) ,peakdisplaywidth*ScaleFactorx  ,heightperchn);
+            }
+            else
+            {
+                float normscalepos = displaySizeNorm-scalechangePixels; // 
+                float xpos = normscalepos-normscalepos/48.0*(peaklog+12.0)*(-1.0);
+                g.fillRect(float (r.getX())+ xpos*ScaleFactorx ,float(r.getY())+ kk*(heightperchn+border),peakdisplaywidth*ScaleFactorx ,heightperchn);
+            }
+        }
+        
+        // draw RMS 
+        if (rmslog >= greenfrom)
+        {
+            g.setColour(g1);
+            float normscalepos;
+            float xpos;
+            if (rmslog < yellowfrom)
             {
-                Colour peakcolor;
-                if (peaklog >= redfrom)
-                    peakcolor = r1;
-                else 
-                {
-                    if (peaklog < redfrom && peaklog > yellowfrom)
-                        peakcolor = y1;
-                    else
-                        peakcolor = g1;
-                }    
-                g.setColour(peakcolor.brighter(0.5));
                 
-                if (peaklog > scale3dbFrom)
+                if (rmslog >= scale3dbFrom)
                 {
-                    float normscalepos = scalechangePixels - peakdisplaywidth;
-                    float xpos = normscalepos- normscalepos/18.0*(peaklog-6.0)*(-1.0);
-                    g.fillRect(float (r.getX())+ (w-2*border)*0.4 + xpos*ScaleFactorx ,float(r.getY())+ kk*(heightperchn+border) ,peakdisplaywidth*ScaleFactorx  ,heightperchn);
+                    normscalepos = scalechangePixels - yellownormpixels-rednormpixels;
+                    xpos = normscalepos-normscalepos/3.0*(rmslog+9.0)*(-1.0);    
+                    xpos += (displaySizeNorm-scalechangePixels);         
                 }
                 else
                 {
-                    float normscalepos = displaySizeNorm-scalechangePixels; // 
-                    //float ypos = normscalepos/48.0*(peaklog+12.0)*(-1.0)+1.0;
-                    float xpos = normscalepos-normscalepos/48.0*(peaklog+12.0)*(-1.0);
-                    g.fillRect(float (r.getX())+ xpos*ScaleFactorx ,float(r.getY())+ kk*(heightperchn+border),peakdisplaywidth*ScaleFactorx ,heightperchn);
+                    normscalepos = displaySizeNorm-scalechangePixels;
+                    xpos = normscalepos-normscalepos/48.0*(rmslog+12.0)*(-1.0) ;                
                 }
+                g.fillRect(float (r.getX()),float(r.getY())+ kk*(heightperchn+border) ,xpos*ScaleFactorx,heightperchn);
             }
             
-            // draw RMS 
-            float rmslog = 10*log10(m_rms[kk] + 0.00000000001); // -110dB
-            if (rmslog>maxvalPeakOrRMS)
-                rmslog = maxvalPeakOrRMS;
-           
-            if (rmslog >= greenfrom)
+            else
             {
-                g.setColour(g1);
-                float normscalepos;
-                float xpos;
-                if (rmslog < yellowfrom)
+                g.fillRect(float (r.getX()),float(r.getY())+ kk*(heightperchn+border),(w-2*border)*0.5  ,heightperchn);
+
+                g.setColour(y1);
+                if (rmslog < redfrom)
                 {
-                    
-                    if (rmslog >= scale3dbFrom)
-                    {
-                        normscalepos = scalechangePixels - yellownormpixels-rednormpixels;
-                        xpos = normscalepos-normscalepos/3.0*(rmslog+9.0)*(-1.0);    
-                        xpos += (displaySizeNorm-scalechangePixels);         
-                    }
-                    else
-                    {
-                        normscalepos = displaySizeNorm-scalechangePixels;
-                        xpos = normscalepos-normscalepos/48.0*(rmslog+12.0)*(-1.0) ;                
-                    }
-                    g.fillRect(float (r.getX()),float(r.getY())+ kk*(heightperchn+border) ,xpos*ScaleFactorx,heightperchn);
+                    normscalepos = yellownormpixels;
+                    xpos = normscalepos-normscalepos/9.0*(rmslog)*(-1.0);                
+                    g.fillRect(float (r.getX()) + (w-2*border)*0.5,float(r.getY())+ kk*(heightperchn+border) ,xpos*ScaleFactorx,heightperchn);
                 }
-                
                 else
                 {
-                    g.fillRect(float (r.getX()),float(r.getY())+ kk*(heightperchn+border),(w-2*border)*0.5  ,heightperchn);
-
-                    g.setColour(y1);
-                    if (rmslog < redfrom)
-                    {
-                        normscalepos = yellownormpixels;
-                        xpos = normscalepos-normscalepos/9.0*(rmslog)*(-1.0);                
-                        g.fillRect(float (r.getX()) + (w-2*border)*0.5,float(r.getY())+ kk*(heightperchn+border) ,xpos*ScaleFactorx,heightperchn);
-                    }
-                    else
-                    {
-                        g.fillRect(float (r.getX())+ (w-2*border)*0.5,float(r.getY())+ kk*(heightperchn+border),(w-2*border)*0.3  ,heightperchn);
-                        g.setColour(r1);
-                        // red part
-                        normscalepos = rednormpixels;
-                        xpos = normscalepos/6.0*(rmslog);                
-                        g.fillRect(float (r.getX()) + (w-2*border)*0.8,float(r.getY())+ kk*(heightperchn+border) ,xpos*ScaleFactorx,heightperchn);
-                    }
-                    
+                    g.fillRect(float (r.getX())+ (w-2*border)*0.5,float(r.getY())+ kk*(heightperchn+border),(w-2*border)*0.3  ,heightperchn);
+                    g.setColour(r1);
+                    // red part
+                    normscalepos = rednormpixels;
+                    xpos = normscalepos/6.0*(rmslog);                
+                    g.fillRect(float (r.getX()) + (w-2*border)*0.8,float(r.getY())+ kk*(heightperchn+border) ,xpos*ScaleFactorx,heightperchn);
                 }
+                
             }
         }
     }
     else // vertical meter
     {
-        float ScaleFactory = h/normSizey;
-        float ScaleFactorx = w/normSizex;
-        displaySizeNorm = normSizey- 2.0*border;
-        border *= ScaleFactory;
-        r.reduce(border, border);
-        float remindingpixels = normSizex*ScaleFactorx - (2.0+m_displaychannels-1.0)*border;
-        float widthperchn = remindingpixels/m_displaychannels;
-        // draw channels background
-        for (size_t kk = 0; kk<m_displaychannels; kk++)
+        float widthperchn = geo.sizeperchn;
+        // draw Peak 
+        if (peaklog>greenfrom)
         {
-            Colour r1 = juce::Colours::red;
-            g.setColour(r1.darker(0.95));
-            g.fillRect(float (r.getX()) + kk*(widthperchn+border),float(r.getY()),widthperchn,(h-2*border)*0.2);
-
-
-            Colour y1 = juce::Colours::yellow ;
-            g.setColour(y1.darker(0.95));
-            g.fillRect(float (r.getX())+ kk*(widthperchn+border),float(r.getY()) + (h-2*border)*0.2 ,widthperchn,(h-2*border)*0.3);
-
-            Colour g1 = juce::Colours::green;
-            g.setColour(g1.darker(0.95));
-            g.fillRect(float (r.getX())+ kk*(widthperchn+border),float(r.getY()) + (h-2*border)*0.5 ,widthperchn,(h-2*border)*0.5);
-        
-            // draw Peak 
-            float peaklog = 20*log10(m_peak[kk] + 0.00000000001);
-            if (peaklog >= maxvalPeakOrRMS)
-                peaklog = maxvalPeakOrRMS;
-
-            if (peaklog>greenfrom)
+            Colour peakcolor;
+            if (peaklog >= redfrom)
+                peakcolor = r1;
+            else 
             {
-                Colour peakcolor;
-                if (peaklog >= redfrom)
-                    peakcolor = r1;
-                else 
-                {
-                    if (peaklog < redfrom && peaklog > yellowfrom)
-                        peakcolor = y1;
-                    else
-                        peakcolor = g1;
-                }    
-                g.setColour(peakcolor.brighter(0.5));
-                
-                if (peaklog > scale3dbFrom)
+                if (peaklog < redfrom && peaklog > yellowfrom)
+                    peakcolor = y1;
+                else
+                    peakcolor = g1;
+            }    
+            g.setColour(peakcolor.brighter(0.5));
+            
+            if (peaklog > scale3dbFrom)
+            {
+                float normscalepos = scalechangePixels;
+                float ypos = normscalepos/18.0*(peaklog-6.0)*(-1.0);
+                g.fillRect(float (r.getX())+ kk*(widthperchn+border),float(r.getY()) +ypos*ScaleFactory   ,widthperchn, peakdisplaywidth*ScaleFactory);
+            }
+            else
+            {
+                float normscalepos = displaySizeNorm-scalechangePixels- peakdisplaywidth; // 40-3 for the drawing
+                float ypos = normscalepos/48.0*(peaklog+12.0)*(-1.0);
+                g.fillRect(float (r.getX())+ kk*(widthperchn+border),float(r.getY()) +60.0*ScaleFactory +ypos*ScaleFactory   ,widthperchn, peakdisplaywidth*ScaleFactory);
+            }
+        }
+        // draw RMS 
+        if (rmslog >= greenfrom)
+        {
+            g.setColour(g1);
+            float normscalepos;
+            float ypos;
+            if (rmslog < yellowfrom)
+            {
+                if (rmslog >= scale3dbFrom)
                 {
-                    float normscalepos = scalechangePixels;
-                    float ypos = normscalepos/18.0*(peaklog-6.0)*(-1.0);
-                    g.fillRect(float (r.getX())+ kk*(widthperchn+border),float(r.getY()) +ypos*ScaleFactory   ,widthperchn, peakdisplaywidth*ScaleFactory);
+                    normscalepos = scalechangePixels - yellownormpixels-rednormpixels;
+                    ypos = normscalepos/3.0*(rmslog+9.0)*(-1.0);                
                 }
                 else
                 {
-                    float normscalepos = displaySizeNorm-scalechangePixels- peakdisplaywidth; // 40-3 for the drawing
-                    //float ypos = normscalepos/48.0*(peaklog+12.0)*(-1.0)+1.0;
-                    float ypos = normscalepos/48.0*(peaklog+12.0)*(-1.0);
-                    g.fillRect(float (r.getX())+ kk*(widthperchn+border),float(r.getY()) +60.0*ScaleFactory +ypos*ScaleFactory   ,widthperchn, peakdisplaywidth*ScaleFactory);
+                    normscalepos = displaySizeNorm-scalechangePixels;
+                    ypos = normscalepos/48.0*(rmslog+12.0)*(-1.0) + 10.0;                
                 }
+                
+                g.fillRect(float (r.getX())+ kk*(widthperchn+border),float(r.getY()) + (h-2*border)*0.5 + ypos*ScaleFactory ,widthperchn,(h-2*border)*0.5-ypos*ScaleFactory);
             }
-            // draw RMS 
-            float rmslog = 10*log10(m_rms[kk] + 0.00000000001); // -110dB
-            if (rmslog>maxvalPeakOrRMS)
-                rmslog = maxvalPeakOrRMS;
-           
-            if (rmslog >= greenfrom)
+            else
             {
-                g.setColour(g1);
-                float normscalepos;
-                float ypos;
-                if (rmslog < yellowfrom)
+                g.fillRect(float (r.getX())+ kk*(widthperchn+border),float(r.getY()) + (h-2*border)*0.5 ,widthperchn,(h-2*border)*0.5);
+                g.setColour(y1);
+                if (rmslog < redfrom)
                 {
-                    //float startvaly = 51;
-                    if (rmslog >= scale3dbFrom)
-                    {
-                        normscalepos = scalechangePixels - yellownormpixels-rednormpixels;
-                        ypos = normscalepos/3.0*(rmslog+9.0)*(-1.0);                
-                    }
-                    else
-                    {
-                        normscalepos = displaySizeNorm-scalechangePixels;
-                        ypos = normscalepos/48.0*(rmslog+12.0)*(-1.0) + 10.0;                
-                    }
-                    
-                
-                    g.fillRect(float (r.getX())+ kk*(widthperchn+border),float(r.getY()) + (h-2*border)*0.5 + ypos*ScaleFactory ,widthperchn,(h-2*border)*0.5-ypos*ScaleFactory);
+                    normscalepos = yellownormpixels;
+                    ypos = normscalepos/9.0*(rmslog)*(-1.0);                
+                    g.fillRect(float (r.getX())+ kk*(widthperchn+border),float(r.getY()) + (h-2*border)*0.2 + ypos*ScaleFactory ,widthperchn,(h-2*border)*0.3-ypos*ScaleFactory);
+
                 }
                 else
                 {
-                    g.fillRect(float (r.getX())+ kk*(widthperchn+border),float(r.getY()) + (h-2*border)*0.5 ,widthperchn,(h-2*border)*0.5);
-                    g.setColour(y1);
-                    if (rmslog < redfrom)
-                    {
-                        normscalepos = yellownormpixels;
-                        ypos = normscalepos/9.0*(rmslog)*(-1.0);                
-                        g.fillRect(float (r.getX())+ kk*(widthperchn+border),float(r.getY()) + (h-2*border)*0.2 + ypos*ScaleFactory ,widthperchn,(h-2*border)*0.3-ypos*ScaleFactory);
-
-                    }
-                    else
-                    {
-                        g.fillRect(float (r.getX())+ kk*(widthperchn+border),float(r.getY()) + (h-2*border)*0.2 ,widthperchn,(h-2*border)*0.3);
-                        g.setColour(r1);
-                        // red part
-                        normscalepos = rednormpixels;
-                        ypos = normscalepos-normscalepos/6.0*(rmslog);                
-                        g.fillRect(float (r.getX())+ kk*(widthperchn+border),float(r.getY()) + ypos*ScaleFactory ,widthperchn,(h-2*border)*0.2-ypos*ScaleFactory);
-
-                    }
-                    
+                    g.fillRect(float (r.getX())+ kk*(widthperchn+border),float(r.getY()) + (h-2*border)*0.2 ,widthperchn,(h-2*border)*0.3);
+                    g.setColour(r1);
+                    // red part
+                    normscalepos = rednormpixels;
+                    ypos = normscalepos-normscalepos/6.0*(rmslog);                
+                    g.fillRect(float (r.getX())+ kk*(widthperchn+border),float(r.getY()) + ypos*ScaleFactory ,widthperchn,(h-2*border)*0.2-ypos*ScaleFactory);
                 }
             }
-
-
         }
     }
 }    
 
 void SimpleMeterComponent::resized()
 {
-    
+    updateGeometry();
 }
-
-
@@ -57,19 +57,17 @@ private:
     void reset();
 };
 
-class SimpleMeterComponent : public Component, public Timer
+class SimpleMeterComponent : public Component
 {
 public:
     SimpleMeterComponent(SimpleMeter &meter);
-    ~SimpleMeterComponent(){stopTimer();};
+    ~SimpleMeterComponent(){};
 	void paint(Graphics& g) override;
 	void resized() override;
     void setScaleFactor(float newscale){m_scaleFactor = newscale;};
-    void timerCallback() override
-    {
-        m_displaychannels = m_meter.getAnalyserData(m_rms,m_peak);
-        repaint();
-    };
+    // polled once per frame by the GUI (see InvalidationScheduler), 
+    // repaints only the channels that moved by at least one pixel
+    void updateFromMeter();
 private:
     float m_scaleFactor;
     SimpleMeter& m_meter;
@@ -77,4 +75,31 @@ private:
     std::vector<float> m_peak;
     size_t m_displaychannels; 
 
-};
\ No newline at end of file
+    // displayed levels in dB and their position in pixels along the meter
+    std::vector<float> m_rms_dB;
+    std::vector<float> m_peak_dB;
+    std::vector<float> m_rmsPixels;
+    std::vector<float> m_peakPixels;
+
+    // geometry for the current size and number of channels
+    struct Geometry
+    {
+        bool horizontal;
+        Rectangle<int> r;
+        float border;
+        float ScaleFactorx;
+        float ScaleFactory;
+        float displaySizeNorm;
+        float sizeperchn;
+        float pixelScale;
+    } m_geometry;
+    void updateGeometry();
+    Rectangle<int> getChannelBounds(size_t kk) const;
+    float levelToPixels(float level_dB) const;
+
+    // the colour zones only change with the size, they are drawn once into this image
+    Image m_background;
+    bool m_backgroundIsValid;
+    void paintBackground(Graphics& g);
+    void paintLevels(Graphics& g, size_t kk);
+};
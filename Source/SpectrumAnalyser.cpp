@@ -0,0 +1,323 @@
+/*
+  ==============================================================================
+    SpectrumAnalyser.cpp
+
+    Authors:    agent
+
+    SPDX-License-Identifier: BSD-3-Clause
+ ==============================================================================
+*/
+
+#include "SpectrumAnalyser.h"
+#include "FastMath.h"
+
+static const int g_fftSize = 1 << SPECTRUM_FFT_ORDER;
+static const int g_nrofbins = g_fftSize / 2 + 1;
+// latencies above this are not compensated
+static const int g_maxLatency = g_fftSize;
+
+SpectrumAnalyser::SpectrumAnalyser()
+:Thread("FDM spectrum"),m_fs(48000.f),m_latency(0),m_active(false),m_inputMixSize(0),m_fifo(SPECTRUM_FIFO_SIZE),
+m_bandFs(0.f),m_frameLatency(0),m_frameFill(0),
+m_fft(SPECTRUM_FFT_ORDER),m_window(g_fftSize, dsp::WindowingFunction<float>::hann),m_hasNewData(false)
+{
+    m_outputMix.resize(SPECTRUM_MIX_BLOCK_SIZE);
+    m_ring.resize(2 * SPECTRUM_FIFO_SIZE);
+
+    m_inputFrame.resize(g_fftSize + g_maxLatency);
+    m_outputFrame.resize(g_fftSize);
+    for (auto signal = 0; signal < nrofsignals; ++signal)
+    {
+        // the real only transform needs twice the FFT size
+        m_fftData[signal].resize(2 * g_fftSize);
+        m_binPower[signal].resize(g_nrofbins);
+        m_welchPower[signal].resize(g_nrofbins);
+        m_bandPower[signal].resize(SPECTRUM_NUM_BANDS);
+    }
+    m_welchCrossRe.resize(g_nrofbins);
+    m_welchCrossIm.resize(g_nrofbins);
+
+    m_bandStartBin.resize(SPECTRUM_NUM_BANDS);
+    m_bandEndBin.resize(SPECTRUM_NUM_BANDS);
+    m_bandCentreBin.resize(SPECTRUM_NUM_BANDS);
+    m_bandFrequency.resize(SPECTRUM_NUM_BANDS);
+
+    m_ready.frequency.resize(SPECTRUM_NUM_BANDS);
+    m_ready.input_dB.resize(SPECTRUM_NUM_BANDS, SPECTRUM_FLOOR_DB);
+    m_ready.output_dB.resize(SPECTRUM_NUM_BANDS, SPECTRUM_FLOOR_DB);
+    m_ready.transfer_dB.resize(SPECTRUM_NUM_BANDS, SPECTRUM_FLOOR_DB);
+    m_ready.coherence.resize(SPECTRUM_NUM_BANDS, 0.f);
+}
+
+SpectrumAnalyser::~SpectrumAnalyser()
+{
+    stopThread(1000);
+}
+
+void SpectrumAnalyser::prepareToPlay(float samplerate, int samplesPerBlock, int latencySamples)
+{
+    m_inputMix.resize(samplesPerBlock);
+    m_inputMixSize = 0;
+    // the band mapping and the latency are taken over by the analyser thread
+    m_latency = jlimit(0, g_maxLatency, latencySamples);
+    m_fs = samplerate;
+}
+
+void SpectrumAnalyser::mixDown(float* mix, const AudioBuffer<float>& data, int nrofchannels, int startSample, int nrofsamples)
+{
+    float gain = 1.f / nrofchannels;
+    FloatVectorOperations::multiply(mix, data.getReadPointer(0, startSample), gain, nrofsamples);
+    for (int channel = 1; channel < nrofchannels; ++channel)
+        FloatVectorOperations::addWithMultiply(mix, data.getReadPointer(channel, startSample), gain, nrofsamples);
+}
+
+void SpectrumAnalyser::pushInput(const AudioBuffer<float>& data, int nrofchannels)
+{
+    m_inputMixSize = 0;
+    nrofchannels = jmin(nrofchannels, data.getNumChannels());
+    if (!m_active.load() || nrofchannels <= 0)
+        return;
+
+    // larger blocks than announced in prepareToPlay are analysed in part only
+    m_inputMixSize = jmin(data.getNumSamples(), static_cast<int>(m_inputMix.size()));
+    mixDown(m_inputMix.data(), data, nrofchannels, 0, m_inputMixSize);
+}
+
+void SpectrumAnalyser::pushOutput(const AudioBuffer<float>& data, int nrofchannels)
+{
+    nrofchannels = jmin(nrofchannels, data.getNumChannels());
+    if (!m_active.load() || nrofchannels <= 0)
+        return;
+
+    int totalSamples = jmin(m_inputMixSize, data.getNumSamples());
+    for (int pos = 0; pos < totalSamples; pos += SPECTRUM_MIX_BLOCK_SIZE)
+    {
+        int nrofsamples = jmin(SPECTRUM_MIX_BLOCK_SIZE, totalSamples - pos);
+        mixDown(m_outputMix.data(), data, nrofchannels, pos, nrofsamples);
+
+        // if the FIFO is full, the rest of the block is dropped
+        int start1, size1, start2, size2;
+        m_fifo.prepareToWrite(nrofsamples, start1, size1, start2, size2);
+        const float* in = m_inputMix.data() + pos;
+        for (int kk = 0; kk < size1; ++kk)
+        {
+            m_ring[2 * (start1 + kk)] = in[kk];
+            m_ring[2 * (start1 + kk) + 1] = m_outputMix[kk];
+        }
+        for (int kk = 0; kk < size2; ++kk)
+        {
+            m_ring[2 * (start2 + kk)] = in[size1 + kk];
+            m_ring[2 * (start2 + kk) + 1] = m_outputMix[size1 + kk];
+        }
+        m_fifo.finishedWrite(size1 + size2);
+    }
+    m_inputMixSize = 0;
+}
+
+void SpectrumAnalyser::setActive(bool active)
+{
+    m_active = active;
+    if (active)
+        startThread(2);
+    else
+        stopThread(1000);
+}
+
+bool SpectrumAnalyser::getSpectrum(Spectrum& result)
+{
+    const SpinLock::ScopedTryLockType lock(m_resultLock);
+    if (!lock.isLocked() || !m_hasNewData)
+        return false;
+
+    m_hasNewData = false;
+    result.frequency = m_ready.frequency;
+    result.input_dB = m_ready.input_dB;
+    result.output_dB = m_ready.output_dB;
+    result.transfer_dB = m_ready.transfer_dB;
+    result.coherence = m_ready.coherence;
+    return true;
+}
+
+void SpectrumAnalyser::run()
+{
+    // samples from before the (re)start are stale
+    m_fifo.finishedRead(m_fifo.getNumReady());
+    m_bandFs = 0.f;
+
+    while (!threadShouldExit())
+    {
+        if (m_bandFs != m_fs.load() || m_frameLatency != m_latency.load())
+        {
+            computeBands();
+            reset();
+        }
+
+        if (readFrames())
+            publish();
+
+        wait(SPECTRUM_WAIT_TIME_MS);
+    }
+}
+
+bool SpectrumAnalyser::readFrames()
+{
+    bool newFrame = false;
+    while (m_fifo.getNumReady() > 0)
+    {
+        int start1, size1, start2, size2;
+        m_fifo.prepareToRead(jmin(m_fifo.getNumReady(), g_fftSize - m_frameFill), start1, size1, start2, size2);
+        // the input is written behind its latency history
+        float* in = m_inputFrame.data() + m_frameLatency + m_frameFill;
+        float* out = m_outputFrame.data() + m_frameFill;
+        for (int kk = 0; kk < size1; ++kk)
+        {
+            *in++ = m_ring[2 * (start1 + kk)];
+            *out++ = m_ring[2 * (start1 + kk) + 1];
+        }
+        for (int kk = 0; kk < size2; ++kk)
+        {
+            *in++ = m_ring[2 * (start2 + kk)];
+            *out++ = m_ring[2 * (start2 + kk) + 1];
+        }
+        m_fifo.finishedRead(size1 + size2);
+        m_frameFill += size1 + size2;
+
+        if (m_frameFill == g_fftSize)
+        {
+            processFrame();
+            // keep the overlap (and the latency history) for the next frame
+            std::copy(m_inputFrame.begin() + SPECTRUM_HOP_SIZE, m_inputFrame.begin() + m_frameLatency + g_fftSize,
+                m_inputFrame.begin());
+            std::copy(m_outputFrame.begin() + SPECTRUM_HOP_SIZE, m_outputFrame.end(), m_outputFrame.begin());
+            m_frameFill = g_fftSize - SPECTRUM_HOP_SIZE;
+            newFrame = true;
+        }
+    }
+    return newFrame;
+}
+
+void SpectrumAnalyser::processFrame()
+{
+    // x(n) belongs to y(n + latency): the input frame starts at the oldest sample of its history
+    const float* frames[nrofsignals] = { m_inputFrame.data(), m_outputFrame.data() };
+    for (auto signal = 0; signal < nrofsignals; ++signal)
+    {
+        auto& data = m_fftData[signal];
+        std::copy(frames[signal], frames[signal] + g_fftSize, data.begin());
+        std::fill(data.begin() + g_fftSize, data.end(), 0.f);
+        m_window.multiplyWithWindowingTable(data.data(), g_fftSize);
+        // bins 0...fftSize/2 as interleaved real and imaginary part
+        m_fft.performRealOnlyForwardTransform(data.data(), true);
+    }
+
+    const float* x = m_fftData[input].data();
+    const float* y = m_fftData[output].data();
+    for (auto bin = 0; bin < g_nrofbins; ++bin)
+    {
+        float xRe = x[2 * bin], xIm = x[2 * bin + 1];
+        float yRe = y[2 * bin], yIm = y[2 * bin + 1];
+        float inputPower = xRe * xRe + xIm * xIm;
+        float outputPower = yRe * yRe + yIm * yIm;
+        m_binPower[input][bin] = inputPower;
+        m_binPower[output][bin] = outputPower;
+
+        // conj(X) Y
+        const float alpha = SPECTRUM_WELCH_AVERAGING;
+        m_welchPower[input][bin] = alpha * m_welchPower[input][bin] + (1.f - alpha) * inputPower;
+        m_welchPower[output][bin] = alpha * m_welchPower[output][bin] + (1.f - alpha) * outputPower;
+        m_welchCrossRe[bin] = alpha * m_welchCrossRe[bin] + (1.f - alpha) * (xRe * yRe + xIm * yIm);
+        m_welchCrossIm[bin] = alpha * m_welchCrossIm[bin] + (1.f - alpha) * (xRe * yIm - xIm * yRe);
+    }
+
+    // the window is normalised to a mean of one, a full scale sine gives fftSize/2
+    const float scale = 4.f / (static_cast<float>(g_fftSize) * g_fftSize);
+    for (auto signal = 0; signal < nrofsignals; ++signal)
+    {
+        const auto& power = m_binPower[signal];
+        for (auto band = 0; band < SPECTRUM_NUM_BANDS; ++band)
+        {
+            int startBin = m_bandStartBin[band];
+            int endBin = m_bandEndBin[band];
+            float bandPower;
+            if (endBin - startBin > 1)
+            {
+                // wide bands (high frequencies) show their strongest bin
+                bandPower = *std::max_element(power.begin() + startBin, power.begin() + endBin);
+            }
+            else
+            {
+                // narrow bands (low frequencies) are interpolated at their centre
+                float bin = m_bandFrequency[band] * g_fftSize / m_bandFs;
+                int lowBin = jmin(static_cast<int>(bin), g_nrofbins - 2);
+                float frac = bin - lowBin;
+                bandPower = (1.f - frac) * power[lowBin] + frac * power[lowBin + 1];
+            }
+            m_bandPower[signal][band] = SPECTRUM_SMOOTHING * m_bandPower[signal][band]
+                + (1.f - SPECTRUM_SMOOTHING) * scale * bandPower;
+        }
+    }
+}
+
+void SpectrumAnalyser::publish()
+{
+    const float scale = 4.f / (static_cast<float>(g_fftSize) * g_fftSize);
+    const float minInputPower = std::pow(10.f, 0.1f * SPECTRUM_MIN_INPUT_DB) / scale;
+
+    const SpinLock::ScopedLockType lock(m_resultLock);
+    std::copy(m_bandFrequency.begin(), m_bandFrequency.end(), m_ready.frequency.begin());
+    for (auto band = 0; band < SPECTRUM_NUM_BANDS; ++band)
+    {
+        m_ready.input_dB[band] = jmax(SPECTRUM_FLOOR_DB, fastPowerTodB(m_bandPower[input][band] + 1e-20f));
+        m_ready.output_dB[band] = jmax(SPECTRUM_FLOOR_DB, fastPowerTodB(m_bandPower[output][band] + 1e-20f));
+
+        // the transfer function is measured at the bin next to the band centre,
+        // a sum over the band would cancel where the phase turns fast (resonances)
+        int bin = m_bandCentreBin[band];
+        float inputPower = m_welchPower[input][bin];
+        float outputPower = m_welchPower[output][bin];
+        if (inputPower < minInputPower)
+        {
+            m_ready.transfer_dB[band] = SPECTRUM_FLOOR_DB;
+            m_ready.coherence[band] = 0.f;
+            continue;
+        }
+        float crossPower = m_welchCrossRe[bin] * m_welchCrossRe[bin] + m_welchCrossIm[bin] * m_welchCrossIm[bin];
+        m_ready.transfer_dB[band] = jmax(SPECTRUM_FLOOR_DB,
+            fastPowerTodB(crossPower + 1e-20f) - 2.f * fastPowerTodB(inputPower));
+        m_ready.coherence[band] = jlimit(0.f, 1.f, crossPower / (inputPower * outputPower + 1e-20f));
+    }
+    m_hasNewData = true;
+}
+
+void SpectrumAnalyser::computeBands()
+{
+    m_bandFs = m_fs.load();
+    float ratio = 0.5f * m_bandFs / SPECTRUM_MIN_FREQ;
+    float binsPerHz = g_fftSize / m_bandFs;
+    for (auto band = 0; band < SPECTRUM_NUM_BANDS; ++band)
+    {
+        float lowFreq = SPECTRUM_MIN_FREQ * std::pow(ratio, static_cast<float>(band) / SPECTRUM_NUM_BANDS);
+        float highFreq = SPECTRUM_MIN_FREQ * std::pow(ratio, static_cast<float>(band + 1) / SPECTRUM_NUM_BANDS);
+        m_bandFrequency[band] = std::sqrt(lowFreq * highFreq);
+
+        int startBin = jlimit(1, g_nrofbins - 1, roundToInt(lowFreq * binsPerHz));
+        m_bandStartBin[band] = startBin;
+        m_bandEndBin[band] = jlimit(startBin + 1, g_nrofbins, roundToInt(highFreq * binsPerHz));
+        m_bandCentreBin[band] = jlimit(1, g_nrofbins - 1, roundToInt(m_bandFrequency[band] * binsPerHz));
+    }
+}
+
+void SpectrumAnalyser::reset()
+{
+    // a new sampling rate or latency starts from scratch
+    m_frameLatency = m_latency.load();
+    m_frameFill = 0;
+    std::fill(m_inputFrame.begin(), m_inputFrame.end(), 0.f);
+    for (auto signal = 0; signal < nrofsignals; ++signal)
+    {
+        std::fill(m_welchPower[signal].begin(), m_welchPower[signal].end(), 0.f);
+        std::fill(m_bandPower[signal].begin(), m_bandPower[signal].end(), 0.f);
+    }
+    std::fill(m_welchCrossRe.begin(), m_welchCrossRe.end(), 0.f);
+    std::fill(m_welchCrossIm.begin(), m_welchCrossIm.end(), 0.f);
+}
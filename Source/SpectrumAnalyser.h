@@ -0,0 +1,149 @@
+/*
+  ==============================================================================
+    SpectrumAnalyser.h
+
+    Live spectrum of the plugin input and output for the magnitude plot and a
+    measured transfer function H1(f) = S_xy / S_xx with its coherence
+    |S_xy|^2 / (S_xx S_yy). The measurement includes everything the model does
+    not show (pole protection, clipping, limiter).
+
+    The audio thread keeps a mono mix of the input block and writes it
+    together with the mono mix of the output into one lock-free single
+    producer / single consumer FIFO, so input and output samples stay paired
+    even if samples have to be dropped (analyser inactive or behind).
+
+    An own thread reads the FIFO and computes Hann windowed FFTs with
+    SPECTRUM_HOP_SIZE overlap. The input is delayed by the latency of the
+    processing (limiter look-ahead) before the FFT. The auto and cross spectra
+    are averaged per bin over time (Welch method, as a running average), the
+    spectra for the display are aggregated into log spaced bands and smoothed.
+    The GUI polls the result with getSpectrum(), which never waits for the
+    analyser thread.
+
+    All buffers of the analyser thread are allocated in the constructor.
+
+    Authors:    agent
+
+    SPDX-License-Identifier: BSD-3-Clause
+ ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <JuceHeader.h>
+
+// 4096 samples, 11.7 Hz resolution at 48 kHz
+#define SPECTRUM_FFT_ORDER 12
+// 75 % overlap
+#define SPECTRUM_HOP_SIZE 1024
+// approx. 0.7 s at 48 kHz (input/output pairs)
+#define SPECTRUM_FIFO_SIZE 32768
+// the audio block is mixed down in chunks of this size
+#define SPECTRUM_MIX_BLOCK_SIZE 512
+#define SPECTRUM_NUM_BANDS 256
+#define SPECTRUM_MIN_FREQ 20.f
+// smoothing of the displayed band power from frame to frame (0: none)
+#define SPECTRUM_SMOOTHING 0.7f
+// running Welch average of the auto and cross spectra (approx. 40 frames)
+#define SPECTRUM_WELCH_AVERAGING 0.95f
+// no transfer function is measured below this input level (dBFS)
+#define SPECTRUM_MIN_INPUT_DB -120.f
+#define SPECTRUM_FLOOR_DB -140.f
+#define SPECTRUM_WAIT_TIME_MS 15
+
+class SpectrumAnalyser : private Thread
+{
+public:
+    enum Signals
+    {
+        input,
+        output,
+        nrofsignals
+    };
+
+    struct Spectrum
+    {
+        std::vector<float> frequency;
+        // levels in dBFS, a full scale sine is 0 dB
+        std::vector<float> input_dB;
+        std::vector<float> output_dB;
+        // measured |H1| in dB and the coherence (0...1) of the input and output
+        std::vector<float> transfer_dB;
+        std::vector<float> coherence;
+    };
+
+    SpectrumAnalyser();
+    ~SpectrumAnalyser();
+
+    // latency of the output relative to the input in samples (e.g. limiter look-ahead)
+    void prepareToPlay(float samplerate, int samplesPerBlock, int latencySamples);
+
+    // audio thread, before the processing: the first nrofchannels channels are averaged
+    void pushInput(const AudioBuffer<float>& data, int nrofchannels);
+    // audio thread, after the processing: writes the pairs into the FIFO, never blocks
+    void pushOutput(const AudioBuffer<float>& data, int nrofchannels);
+
+    // message thread: starts or stops the analyser thread
+    void setActive(bool active);
+    bool isActive() const { return m_active.load(); };
+
+    // message thread: copies the latest result
+    // returns false if there is nothing new or the analyser is just writing its result
+    bool getSpectrum(Spectrum& result);
+
+private:
+    void run() override;
+    bool readFrames();
+    void processFrame();
+    void computeBands();
+    void publish();
+    void reset();
+
+    std::atomic<float> m_fs;
+    std::atomic<int> m_latency;
+    std::atomic<bool> m_active;
+
+    // audio thread
+    std::vector<float> m_inputMix;
+    int m_inputMixSize;
+    std::vector<float> m_outputMix;
+    static void mixDown(float* mix, const AudioBuffer<float>& data, int nrofchannels, int startSample, int nrofsamples);
+
+    // interleaved input and output samples
+    AbstractFifo m_fifo;
+    std::vector<float> m_ring;
+
+    // analyser thread
+    float m_bandFs;
+    int m_frameLatency;
+    // the input frame has m_frameLatency samples more history than the output frame
+    std::vector<float> m_inputFrame;
+    std::vector<float> m_outputFrame;
+    int m_frameFill;
+
+    dsp::FFT m_fft;
+    dsp::WindowingFunction<float> m_window;
+    std::vector<float> m_fftData[nrofsignals];
+
+    // per bin: power of the last frame and the Welch averages
+    std::vector<float> m_binPower[nrofsignals];
+    std::vector<float> m_welchPower[nrofsignals];
+    std::vector<float> m_welchCrossRe;
+    std::vector<float> m_welchCrossIm;
+
+    // per band
+    std::vector<int> m_bandStartBin;
+    std::vector<int> m_bandEndBin;
+    std::vector<int> m_bandCentreBin;
+    std::vector<float> m_bandFrequency;
+    std::vector<float> m_bandPower[nrofsignals];
+
+    // result, handed over to the message thread
+    SpinLock m_resultLock;
+    bool m_hasNewData;
+    Spectrum m_ready;
+
+    JUCE_DECLARE_NON_COPYABLE (SpectrumAnalyser)
+};
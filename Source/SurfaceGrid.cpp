@@ -0,0 +1,83 @@
+/*
+  ==============================================================================
+    SurfaceGrid.cpp
+
+    Authors:    agent
+
+    SPDX-License-Identifier: BSD-3-Clause
+ ==============================================================================
+*/
+
+#include "SurfaceGrid.h"
+
+void SurfaceGrid::setSize(int rows, int columns)
+{
+    m_rows = jmax(0, rows);
+    m_columns = jmax(0, columns);
+    m_stride = (m_columns + SURFACE_GRID_ALIGNMENT - 1)/SURFACE_GRID_ALIGNMENT*SURFACE_GRID_ALIGNMENT;
+
+    // one extra row of alignment, HeapBlock only guarantees the malloc alignment
+    m_memory.calloc(static_cast<size_t>(m_rows*m_stride + SURFACE_GRID_ALIGNMENT));
+    auto address = reinterpret_cast<uintptr_t>(m_memory.get());
+    const uintptr_t alignBytes = SURFACE_GRID_ALIGNMENT*sizeof(float);
+    m_data = reinterpret_cast<float*>((address + alignBytes - 1) & ~(alignBytes - 1));
+}
+
+void SurfaceGrid::fill(float value)
+{
+    if (m_data != nullptr)
+        FloatVectorOperations::fill(m_data, value, m_rows*m_stride);
+}
+
+void SurfaceGrid::swap(SurfaceGrid& other) noexcept
+{
+    std::swap(m_rows, other.m_rows);
+    std::swap(m_columns, other.m_columns);
+    std::swap(m_stride, other.m_stride);
+    m_memory.swapWith(other.m_memory);
+    std::swap(m_data, other.m_data);
+}
+
+SurfaceRowPool::SurfaceRowPool(int nrofthreads)
+:m_nrofthreads(getDefaultNumThreads(nrofthreads)), m_pool(m_nrofthreads), m_pendingChunks(0)
+{
+}
+
+SurfaceRowPool::~SurfaceRowPool()
+{
+    m_pool.removeAllJobs(true, 2000);
+}
+
+int SurfaceRowPool::getDefaultNumThreads(int nrofthreads)
+{
+    if (nrofthreads > 0)
+        return nrofthreads;
+
+    return jlimit(1, 7, SystemStats::getNumCpus() - 1);
+}
+
+void SurfaceRowPool::run(int nrofrows, const std::function<void(int, int)>& rowFunction)
+{
+    int nrofchunks = jmin(m_nrofthreads + 1, nrofrows/SURFACE_MIN_ROWS_PER_JOB);
+    if (nrofchunks <= 1)
+    {
+        rowFunction(0, nrofrows);
+        return;
+    }
+
+    m_chunksDone.reset();
+    m_pendingChunks = nrofchunks - 1;
+    for (auto chunk = 1; chunk < nrofchunks; ++chunk)
+    {
+        int firstRow = chunk*nrofrows/nrofchunks;
+        int endRow = (chunk + 1)*nrofrows/nrofchunks;
+        m_pool.addJob([this, &rowFunction, firstRow, endRow]()
+        {
+            rowFunction(firstRow, endRow);
+            if (--m_pendingChunks == 0)
+                m_chunksDone.signal();
+        });
+    }
+    rowFunction(0, nrofrows/nrofchunks);
+    m_chunksDone.wait();
+}
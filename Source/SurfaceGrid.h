@@ -0,0 +1,109 @@
+/*
+  ==============================================================================
+    SurfaceGrid.h
+
+    Contiguous 2D float buffer for the z-plane surface (row = imaginary part,
+    column = real part). Every row starts on a 32 byte boundary, so the row
+    loops vectorise without peeling. SurfaceRowPool spreads the rows of a grid
+    evaluation over a few background threads. warpGridPosition() defines
+    the (static) adaptive sampling of the plane.
+
+    Authors:    agent
+
+    SPDX-License-Identifier: BSD-3-Clause
+ ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <JuceHeader.h>
+
+// in floats, 32 bytes (AVX)
+#define SURFACE_GRID_ALIGNMENT 8
+// smaller chunks are not worth a thread handoff
+#define SURFACE_MIN_ROWS_PER_JOB 16
+// adaptive sampling: 1/(1-strength) times denser at the centre of the warp
+#define SURFACE_WARP_STRENGTH 0.7f
+// width of the unit circle warp in normalised grid units
+#define SURFACE_WARP_CIRCLE_WIDTH 0.06f
+// width of the warp around a single pole or zero (shader path only)
+#define SURFACE_WARP_ROOT_WIDTH 0.04f
+
+/**
+ * moves a point of the uniform grid (normalised 0...1, centre 0.5) radially
+ * towards the unit circle (radius circleRadius in normalised units).
+ * The radius is mapped with r' = c + d(1 - a exp(-(d/w)^2)), d = r - c,
+ * which is monotonic for a < 1, so the grid does not fold. Far from the
+ * circle (centre, corners) the points stay where they are.
+ */
+inline void warpGridPosition(float& x, float& y, float circleRadius)
+{
+    float dx = x - 0.5f;
+    float dy = y - 0.5f;
+    float r = std::sqrt(dx*dx + dy*dy);
+    if (r < 1e-6f)
+        return;
+
+    float d = (r - circleRadius)/SURFACE_WARP_CIRCLE_WIDTH;
+    float newR = circleRadius + (r - circleRadius)*(1.f - SURFACE_WARP_STRENGTH*std::exp(-d*d));
+    x = jlimit(0.f, 1.f, 0.5f + dx*newR/r);
+    y = jlimit(0.f, 1.f, 0.5f + dy*newR/r);
+}
+
+class SurfaceGrid
+{
+public:
+    SurfaceGrid() : m_rows(0), m_columns(0), m_stride(0), m_data(nullptr) {};
+
+    // all values are 0 after a size change
+    void setSize(int rows, int columns);
+    void fill(float value);
+    void swap(SurfaceGrid& other) noexcept;
+
+    int getNumRows() const { return m_rows; };
+    int getNumColumns() const { return m_columns; };
+    // distance between two rows in floats (>= number of columns)
+    int getStride() const { return m_stride; };
+
+    float* getRow(int row) { return m_data + row*m_stride; };
+    const float* getRow(int row) const { return m_data + row*m_stride; };
+
+    float& operator()(int row, int column) { return m_data[row*m_stride + column]; };
+    float operator()(int row, int column) const { return m_data[row*m_stride + column]; };
+
+private:
+    int m_rows;
+    int m_columns;
+    int m_stride;
+    HeapBlock<float> m_memory;
+    float* m_data;
+
+    JUCE_DECLARE_NON_COPYABLE (SurfaceGrid)
+};
+
+class SurfaceRowPool
+{
+public:
+    // nrofthreads <= 0: number of cores - 1 (at most 7)
+    SurfaceRowPool(int nrofthreads = -1);
+    ~SurfaceRowPool();
+
+    /**
+     * calls rowFunction(firstRow, endRow) for consecutive chunks of rows and
+     * returns when all rows are done. The calling thread takes the first
+     * chunk. Not reentrant, call from one thread only.
+     */
+    void run(int nrofrows, const std::function<void(int, int)>& rowFunction);
+
+private:
+    int m_nrofthreads;
+    ThreadPool m_pool;
+    std::atomic<int> m_pendingChunks;
+    WaitableEvent m_chunksDone;
+
+    static int getDefaultNumThreads(int nrofthreads);
+
+    JUCE_DECLARE_NON_COPYABLE (SurfaceRowPool)
+};
@@ -0,0 +1,220 @@
+/*
+  ==============================================================================
+    SurfaceMesh.cpp
+
+    Authors:    agent
+
+    SPDX-License-Identifier: BSD-3-Clause
+ ==============================================================================
+*/
+
+#include "SurfaceMesh.h"
+
+SurfaceMesh::SurfaceMesh()
+:m_rows(0), m_columns(0), m_nrofIndices(0),
+m_positionBuffer(0), m_heightBuffer(0), m_colourBuffer(0), m_indexBuffer(0)
+{
+    buildColourLUT();
+}
+
+SurfaceMesh::~SurfaceMesh()
+{
+    // release() has to be called on the GL thread before
+    jassert(m_positionBuffer == 0);
+}
+
+uint32 SurfaceMesh::toRGBA(Colour colour)
+{
+    // byte order in memory: r, g, b, a
+    uint8 rgba[4] = { colour.getRed(), colour.getGreen(), colour.getBlue(), colour.getAlpha() };
+    uint32 value;
+    std::memcpy(&value, rgba, sizeof(value));
+    return value;
+}
+
+ColourGradient SurfaceMesh::getGradient()
+{
+    ColourGradient gradient = ColourGradient::vertical(ZeroColour, 0.0, PoleColour, 1.0);
+    gradient.addColour(0.3, Colours::green);
+    gradient.addColour(0.5, NeutralColour);
+    gradient.addColour(0.7, Colours::orange);
+    return gradient;
+}
+
+void SurfaceMesh::buildColourLUT()
+{
+    ColourGradient gradient = getGradient();
+    m_colourLUT.resize(SURFACE_COLOUR_LUT_SIZE);
+    for (auto kk = 0; kk < SURFACE_COLOUR_LUT_SIZE; ++kk)
+        m_colourLUT[kk] = toRGBA(gradient.getColourAtPosition(kk/double(SURFACE_COLOUR_LUT_SIZE - 1)));
+}
+
+SurfaceMesh::Attributes SurfaceMesh::getAttributes(OpenGLContext& context, OpenGLShaderProgram& shader)
+{
+    auto id = shader.getProgramID();
+    Attributes attributes;
+    attributes.position = context.extensions.glGetAttribLocation(id, "gridPosition");
+    attributes.height = context.extensions.glGetAttribLocation(id, "height");
+    attributes.colour = context.extensions.glGetAttribLocation(id, "heightColour");
+    return attributes;
+}
+
+void SurfaceMesh::prepare(OpenGLContext& context, int rows, int columns)
+{
+    if (rows != m_rows || columns != m_columns || m_positionBuffer == 0)
+        create(context, rows, columns);
+}
+
+void SurfaceMesh::create(OpenGLContext& context, int rows, int columns)
+{
+    release(context);
+    m_rows = rows;
+    m_columns = columns;
+    if (rows < 2 || columns < 2)
+        return;
+
+    const int nrofVertices = rows*columns;
+    std::vector<float> positions(2*nrofVertices);
+    m_lineMask.resize(nrofVertices);
+
+    // gridlines every 0.5 and the unit circle (same layout as the pole zero plot)
+    const float gridStep = 0.5f;
+    const float nrofGridlines = jmax(paramPoleReal.maxValue - paramPoleReal.minValue,
+        paramPoleImag.maxValue - paramPoleImag.minValue) / gridStep;
+    const float thickness = 0.004f;
+    const float radius = 0.5f / jmax(paramPoleReal.maxValue, paramPoleImag.maxValue);
+
+    float realStep = 1 / static_cast<float>(columns - 1);
+    float imagStep = 1 / static_cast<float>(rows - 1);
+    for (auto kk = 0; kk < rows; ++kk) // imag
+    {
+        for (auto jj = 0; jj < columns; ++jj) // real
+        {
+            int index = kk*columns + jj;
+            float x = jj*realStep;
+            float y = kk*imagStep;
+            // denser around the unit circle, same warp as the CPU evaluation
+            warpGridPosition(x, y, radius);
+            positions[2*index] = x;
+            positions[2*index + 1] = y;
+
+            // distance to the next gridline in grid units
+            float dx = std::abs(x*nrofGridlines - std::round(x*nrofGridlines))/nrofGridlines;
+            float dy = std::abs(y*nrofGridlines - std::round(y*nrofGridlines))/nrofGridlines;
+            float r = std::sqrt((x - 0.5f)*(x - 0.5f) + (y - 0.5f)*(y - 0.5f));
+            m_lineMask[index] = (dx < thickness || dy < thickness
+                || std::abs(r - radius) < thickness) ? 1 : 0;
+        }
+    }
+
+    std::vector<uint32> indices;
+    indices.reserve(6*(rows - 1)*(columns - 1));
+    for (auto kk = 0; kk < rows - 1; ++kk)
+    {
+        for (auto jj = 0; jj < columns - 1; ++jj)
+        {
+            uint32 index1 = static_cast<uint32>(kk*columns + jj);
+            uint32 index2 = index1 + static_cast<uint32>(columns);
+            indices.insert(indices.end(), { index1, index2, index1 + 1, index2, index1 + 1, index2 + 1 });
+        }
+    }
+    m_nrofIndices = static_cast<int>(indices.size());
+
+    auto& ext = context.extensions;
+    ext.glGenBuffers(1, &m_positionBuffer);
+    ext.glBindBuffer(GL_ARRAY_BUFFER, m_positionBuffer);
+    ext.glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(positions.size()*sizeof(float)),
+        positions.data(), GL_STATIC_DRAW);
+
+    ext.glGenBuffers(1, &m_indexBuffer);
+    ext.glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+    ext.glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indices.size()*sizeof(uint32)),
+        indices.data(), GL_STATIC_DRAW);
+
+    // streamed buffers, only allocated here
+    ext.glGenBuffers(1, &m_heightBuffer);
+    ext.glBindBuffer(GL_ARRAY_BUFFER, m_heightBuffer);
+    ext.glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(nrofVertices*sizeof(float)),
+        nullptr, GL_DYNAMIC_DRAW);
+
+    ext.glGenBuffers(1, &m_colourBuffer);
+    ext.glBindBuffer(GL_ARRAY_BUFFER, m_colourBuffer);
+    ext.glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(nrofVertices*sizeof(uint32)),
+        nullptr, GL_DYNAMIC_DRAW);
+
+    m_heights.resize(nrofVertices);
+    m_colours.resize(nrofVertices);
+}
+
+void SurfaceMesh::update(OpenGLContext& context, const SurfaceGrid& heights)
+{
+    prepare(context, heights.getNumRows(), heights.getNumColumns());
+
+    if (m_nrofIndices == 0)
+        return;
+
+    // the GPU buffer has no row padding
+    const float lutScale = static_cast<float>(SURFACE_COLOUR_LUT_SIZE - 1);
+    const uint32 lineColour = toRGBA(Colours::black);
+    for (auto kk = 0; kk < m_rows; ++kk)
+    {
+        const float* row = heights.getRow(kk);
+        float* height = m_heights.data() + kk*m_columns;
+        uint32* colour = m_colours.data() + kk*m_columns;
+        const uint8* mask = m_lineMask.data() + kk*m_columns;
+        std::memcpy(height, row, m_columns*sizeof(float));
+        for (auto jj = 0; jj < m_columns; ++jj)
+        {
+            int lutIndex = static_cast<int>(jlimit(0.f, lutScale, row[jj]*lutScale) + 0.5f);
+            colour[jj] = mask[jj] ? lineColour : m_colourLUT[lutIndex];
+        }
+    }
+
+    auto& ext = context.extensions;
+    ext.glBindBuffer(GL_ARRAY_BUFFER, m_heightBuffer);
+    ext.glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(m_heights.size()*sizeof(float)),
+        m_heights.data());
+    ext.glBindBuffer(GL_ARRAY_BUFFER, m_colourBuffer);
+    ext.glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(m_colours.size()*sizeof(uint32)),
+        m_colours.data());
+    ext.glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void SurfaceMesh::draw(OpenGLContext& context, const Attributes& attributes)
+{
+    if (m_nrofIndices == 0 || attributes.position < 0)
+        return;
+
+    auto& ext = context.extensions;
+    auto enable = [&ext](GLint attribute, GLuint buffer, GLint size, GLenum type, GLboolean normalise)
+    {
+        if (attribute < 0)
+            return;
+
+        ext.glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        ext.glVertexAttribPointer(static_cast<GLuint>(attribute), size, type, normalise, 0, nullptr);
+        ext.glEnableVertexAttribArray(static_cast<GLuint>(attribute));
+    };
+    enable(attributes.position, m_positionBuffer, 2, GL_FLOAT, GL_FALSE);
+    enable(attributes.height, m_heightBuffer, 1, GL_FLOAT, GL_FALSE);
+    enable(attributes.colour, m_colourBuffer, 4, GL_UNSIGNED_BYTE, GL_TRUE);
+
+    ext.glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+    glDrawElements(GL_TRIANGLES, m_nrofIndices, GL_UNSIGNED_INT, nullptr);
+
+    for (auto attribute : { attributes.position, attributes.height, attributes.colour })
+        if (attribute >= 0)
+            ext.glDisableVertexAttribArray(static_cast<GLuint>(attribute));
+}
+
+void SurfaceMesh::release(OpenGLContext& context)
+{
+    if (m_positionBuffer != 0)
+    {
+        GLuint buffers[4] = { m_positionBuffer, m_heightBuffer, m_colourBuffer, m_indexBuffer };
+        context.extensions.glDeleteBuffers(4, buffers);
+    }
+    m_positionBuffer = m_heightBuffer = m_colourBuffer = m_indexBuffer = 0;
+    m_nrofIndices = 0;
+    m_rows = m_columns = 0;
+}
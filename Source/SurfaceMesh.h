@@ -0,0 +1,121 @@
+/*
+  ==============================================================================
+    SurfaceMesh.h
+
+    GPU mesh of the z-plane surface. The grid positions and the triangle
+    indices only depend on the grid size and are uploaded once. The grid is
+    denser around the unit circle (see warpGridPosition). An update
+    streams the heights (1 float per vertex) and the colours (4 bytes per
+    vertex, from a precomputed colormap) into the existing buffers with
+    glBufferSubData. The gridlines and the unit circle are a static mask.
+
+    With the shader evaluation of |H(z)| (see OpenGLAppClass) only the static
+    grid is drawn, the heights and colours are computed from the poles and
+    zeros in SurfaceRootData. The streamed buffers are the CPU fallback.
+
+    All methods except the constructor must be called on the GL thread.
+
+    Authors:    agent
+
+    SPDX-License-Identifier: BSD-3-Clause
+ ==============================================================================
+*/
+
+#pragma once
+
+#include <vector>
+#include <JuceHeader.h>
+#include <juce_opengl/juce_opengl.h>
+#include "SurfaceGrid.h"
+#include "TransferFunLookAndFeel.h"
+#include "PNParameter.h"
+#include "FilterModel.h"
+
+#define SURFACE_COLOUR_LUT_SIZE 1024
+
+// everything the vertex shader needs to evaluate the surface itself
+struct SurfaceRootData
+{
+    // x, y: root, z: on (0/1), w: conjugated (0/1)
+    float zeros[MAX_POLE_INSTANCES][4];
+    float poles[MAX_POLE_INSTANCES][4];
+    float gain_dB = 0.f;
+    // 0 if H = 0 (shown as 0 dB plane)
+    float gainScale = 1.f;
+    // z-plane area of the grid and its resolution
+    float planeMin[2] = { -1.5f, -1.5f };
+    float planeSize[2] = { 3.f, 3.f };
+    int gridSize = 0;
+
+    void setFromModel(const FilterModel& model)
+    {
+        for (auto kk = 0; kk < MAX_POLE_INSTANCES; ++kk)
+        {
+            const FilterModel::Section& section = model.sections[kk];
+            zeros[kk][0] = section.zero.real();
+            zeros[kk][1] = section.zero.imag();
+            zeros[kk][2] = section.zeroOn ? 1.f : 0.f;
+            zeros[kk][3] = section.zeroConj ? 1.f : 0.f;
+            poles[kk][0] = section.pole.real();
+            poles[kk][1] = section.pole.imag();
+            poles[kk][2] = section.poleOn ? 1.f : 0.f;
+            poles[kk][3] = section.poleConj ? 1.f : 0.f;
+        }
+        gainScale = model.gainLin == 0 ? 0.f : 1.f;
+        gain_dB = model.gainLin == 0 ? 0.f : 20.f*std::log10(std::abs(model.gainLin));
+    }
+};
+
+class SurfaceMesh
+{
+public:
+    SurfaceMesh();
+    ~SurfaceMesh();
+
+    // attribute locations of a shader (-1: not used by the shader)
+    struct Attributes
+    {
+        GLint position = -1;
+        GLint height = -1;
+        GLint colour = -1;
+    };
+    // looks up the attributes gridPosition, height and heightColour
+    static Attributes getAttributes(OpenGLContext& context, OpenGLShaderProgram& shader);
+
+    // (re)creates the static buffers if the size changed
+    void prepare(OpenGLContext& context, int rows, int columns);
+    /** streams the (normalised) heights, the static buffers are (re)created on a size change */
+    void update(OpenGLContext& context, const SurfaceGrid& heights);
+    void draw(OpenGLContext& context, const Attributes& attributes);
+
+    int getNumRows() const { return m_rows; };
+    int getNumColumns() const { return m_columns; };
+
+    static uint32 toRGBA(Colour colour);
+    // the colormap of the surface (0: zero, 1: pole)
+    static ColourGradient getGradient();
+
+    // deletes the GL buffers (call before the context is closed)
+    void release(OpenGLContext& context);
+
+private:
+    int m_rows;
+    int m_columns;
+    int m_nrofIndices;
+
+    GLuint m_positionBuffer;
+    GLuint m_heightBuffer;
+    GLuint m_colourBuffer;
+    GLuint m_indexBuffer;
+
+    std::vector<uint32> m_colourLUT;
+    // 1: the vertex lies on a gridline or the unit circle
+    std::vector<uint8> m_lineMask;
+    std::vector<float> m_heights;
+    std::vector<uint32> m_colours;
+
+    void create(OpenGLContext& context, int rows, int columns);
+    void buildColourLUT();
+
+    JUCE_DECLARE_NON_COPYABLE (SurfaceMesh)
+};
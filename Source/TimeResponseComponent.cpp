@@ -0,0 +1,165 @@
+/*
+  ==============================================================================
+    TimeResponseComponent.cpp
+
+    Authors:    agent
+
+    SPDX-License-Identifier: BSD-3-Clause
+ ==============================================================================
+*/
+
+#include "TimeResponseComponent.h"
+
+TimeResponsePlot::TimeResponsePlot(const String& label)
+    : ScaledPlot(true)
+{
+    m_axisLabelX = String("Time / ms");
+    m_axisLabelY = label;
+    m_tickLabelScaleX = 1.0;
+    m_withAutoStepY = true;
+    m_withZoom = true;
+    setFullRangeX(0.0, 10.0);
+}
+
+TimeResponseComponent::TimeResponseComponent(FilterModelStore& modelStore)
+    : m_modelStore(modelStore), m_modelVersion(0), m_fs(48000.0f),
+    m_impulsePlot("Impulse response"), m_stepPlot("Step response"), m_hasNewData(false)
+{
+    addAndMakeVisible(m_impulsePlot);
+    addAndMakeVisible(m_stepPlot);
+
+    for (auto kk = 0; kk < MAX_POLE_INSTANCES; ++kk)
+    {
+        m_cascade[kk].setClipValue(SOS_CLIP_VALUE);
+        m_acceptedSOS[kk] = {1.f, 0.f, 0.f, 0.f, 0.f};
+    }
+
+    for (auto vec : { &m_time, &m_impulse, &m_step, &m_readyTime, &m_readyImpulse, &m_readyStep,
+            &m_plotTime, &m_plotImpulse, &m_plotStep })
+        vec->reserve(TIME_RESPONSE_MAX_SAMPLES);
+
+    // first data synchronous, all updates come from the analysis worker
+    compute(*m_modelStore.getModel());
+    publish();
+}
+
+TimeResponseComponent::~TimeResponseComponent()
+{
+}
+
+void TimeResponseComponent::paint(Graphics& g)
+{
+    g.fillAll (getLookAndFeel().findColour (ResizableWindow::backgroundColourId));
+}
+
+void TimeResponseComponent::resized()
+{
+    auto bounds = getLocalBounds();
+    m_impulsePlot.setBounds(bounds.removeFromTop(bounds.getHeight() / 2));
+    m_stepPlot.setBounds(bounds);
+}
+
+void TimeResponseComponent::setSamplingRate(float fs)
+{
+    m_fs = fs;
+    // the time axis changed, the next compute is done even for the same model
+    m_modelVersion = 0;
+}
+
+int TimeResponseComponent::getResponseLength(const FilterModel& model)
+{
+    float maxRadius = 0.f;
+    for (const auto& pole : model.poles)
+        maxRadius = jmax(maxRadius, std::abs(pole));
+
+    // FIR part (2 zeros per section) plus the decay of the slowest pole
+    double nrofsamples = 2*MAX_POLE_INSTANCES + 1;
+    if (maxRadius >= 1.f)
+        return TIME_RESPONSE_MAX_SAMPLES;
+
+    if (maxRadius > 0.f)
+        nrofsamples += -TIME_RESPONSE_DECAY_DB/20.0*std::log(10.0)/std::log(maxRadius);
+
+    return jlimit(TIME_RESPONSE_MIN_SAMPLES, TIME_RESPONSE_MAX_SAMPLES, static_cast<int>(std::ceil(nrofsamples)));
+}
+
+void TimeResponseComponent::acceptCoeffs(const FilterModel& model)
+{
+    for (auto kk = 0; kk < MAX_POLE_INSTANCES; ++kk)
+    {
+        const auto& c = model.sos[kk];
+        if (isSectionAccepted(model.poleProtect, model.sections[kk].poleConj, c.a1, c.a2))
+            m_acceptedSOS[kk] = c;
+        m_cascade[kk].setUseNL(useSectionClipping(model.poleProtect));
+    }
+}
+
+void TimeResponseComponent::runCascade(const std::vector<float>& in, std::vector<float>& out)
+{
+    int nrofsamples = static_cast<int>(in.size());
+    out.resize(nrofsamples);
+    for (auto kk = 0; kk < MAX_POLE_INSTANCES; ++kk)
+    {
+        const auto& c = m_acceptedSOS[kk];
+        // time invariant processing with the new coefficients, no cross fade from old ones
+        m_cascade[kk].reset();
+        m_cascade[kk].setCoeffs(c.b0, c.b1, c.b2, c.a1, c.a2);
+        m_cascade[kk].processData(kk == 0 ? in.data() : out.data(), out.data(), nrofsamples);
+    }
+    // the same limit as the health guard of the processor (NaN fails the comparison)
+    for (auto nn = 0; nn < nrofsamples; ++nn)
+    {
+        if (!(std::abs(out[nn]) < HEALTH_MAX_VALUE))
+        {
+            std::fill(out.begin() + nn, out.end(), 0.f);
+            break;
+        }
+    }
+}
+
+void TimeResponseComponent::compute(const FilterModel& model)
+{
+    if (model.version == m_modelVersion)
+        return;
+
+    m_modelVersion = model.version;
+    int nrofsamples = getResponseLength(model);
+
+    float timeStep = 1000.f/m_fs.load();
+    m_time.resize(nrofsamples);
+    for (auto nn = 0; nn < nrofsamples; ++nn)
+        m_time[nn] = nn*timeStep;
+
+    // impulse and step are the input here, the cascade overwrites them with the responses
+    acceptCoeffs(model);
+    m_impulse.assign(nrofsamples, 0.f);
+    m_impulse[0] = 1.f;
+    runCascade(m_impulse, m_impulse);
+    m_step.assign(nrofsamples, 1.f);
+    runCascade(m_step, m_step);
+
+    const ScopedLock lock(m_resultLock);
+    m_readyTime = m_time;
+    m_readyImpulse = m_impulse;
+    m_readyStep = m_step;
+    m_hasNewData = true;
+}
+
+void TimeResponseComponent::publish()
+{
+    {
+        const ScopedLock lock(m_resultLock);
+        if (!m_hasNewData)
+            return;
+
+        m_hasNewData = false;
+        m_plotTime.swap(m_readyTime);
+        m_plotImpulse.swap(m_readyImpulse);
+        m_plotStep.swap(m_readyStep);
+    }
+    double length_ms = m_plotTime.empty() ? 10.0 : m_plotTime.back();
+    m_impulsePlot.setLength_ms(length_ms);
+    m_stepPlot.setLength_ms(length_ms);
+    m_impulsePlot.setData(m_plotTime, m_plotImpulse);
+    m_stepPlot.setData(m_plotTime, m_plotStep);
+}
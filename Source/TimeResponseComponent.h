@@ -0,0 +1,97 @@
+/*
+  ==============================================================================
+    TimeResponseComponent.h
+
+    Impulse and step response of the current design. Both are produced by
+    running the SOSFilter cascade with the coefficients of the filter model
+    offline on the analysis worker, not from the poles and zeros. The cascade
+    follows the processor: pole protection keeps the last accepted
+    coefficients of a rejected section (isSectionAccepted), the sections clip
+    without pole protection (useSectionClipping), and the output is muted
+    once a sample is not finite or reaches HEALTH_MAX_VALUE. The processor
+    mutes the whole host block that contains such a sample and restarts the
+    sections; the view has no block grid, so it mutes from this sample on.
+    The length follows the decay of the largest pole radius
+    (TIME_RESPONSE_DECAY_DB). Results are cached by model version, so an
+    unchanged design costs nothing.
+
+    Authors:    agent
+
+    SPDX-License-Identifier: BSD-3-Clause
+ ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <JuceHeader.h>
+#include "ScaledPlot.h"
+#include "SOSFilter.h"
+#include "FilterModel.h"
+#include "AnalysisWorker.h"
+
+#define TIME_RESPONSE_MIN_SAMPLES 64
+#define TIME_RESPONSE_MAX_SAMPLES 16384
+#define TIME_RESPONSE_DECAY_DB 80.0
+
+class TimeResponsePlot : public ScaledPlot
+{
+public:
+    TimeResponsePlot(const String& label);
+
+    // time axis in ms
+    void setLength_ms(double length_ms)
+    {
+        if (length_ms != m_fullMaxValueX)
+            setFullRangeX(0.0, length_ms);
+    };
+
+private:
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TimeResponsePlot)
+};
+
+class TimeResponseComponent : public Component, public AnalysisWorker::Task
+{
+public:
+    TimeResponseComponent(FilterModelStore& modelStore);
+    ~TimeResponseComponent();
+
+    void paint(Graphics& g) override;
+    void resized() override;
+
+    void setSamplingRate(float fs);
+
+    // analysis worker thread
+    void compute(const FilterModel& model) override;
+    // message thread
+    void publish() override;
+
+    // number of samples until the slowest pole decayed by TIME_RESPONSE_DECAY_DB
+    static int getResponseLength(const FilterModel& model);
+
+private:
+    FilterModelStore& m_modelStore;
+    std::atomic<uint32> m_modelVersion;
+    std::atomic<float> m_fs;
+
+    TimeResponsePlot m_impulsePlot;
+    TimeResponsePlot m_stepPlot;
+
+    // used by the worker only
+    SOSFilter<float> m_cascade[MAX_POLE_INSTANCES];
+    // last coefficients accepted by the pole protection, like in the processor
+    FilterModel::SOSCoeffs m_acceptedSOS[MAX_POLE_INSTANCES];
+    std::vector<float> m_time, m_impulse, m_step;
+    // takes the coefficients and the clipping of the model
+    void acceptCoeffs(const FilterModel& model);
+    void runCascade(const std::vector<float>& in, std::vector<float>& out);
+
+    // finished results, handed over to the message thread
+    CriticalSection m_resultLock;
+    bool m_hasNewData;
+    std::vector<float> m_readyTime, m_readyImpulse, m_readyStep;
+    std::vector<float> m_plotTime, m_plotImpulse, m_plotStep;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TimeResponseComponent)
+};
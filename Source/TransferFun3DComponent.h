@@ -32,18 +32,22 @@
 #include "OpenGLAppClass.h"
 #include "TransferFunLookAndFeel.h"
 #include "PNParameter.h"
+#include "FilterModel.h"
+#include "AnalysisWorker.h"
+#include "SurfaceGrid.h"
+#include "FastMath.h"
 
 
 //==============================================================================
 /*
 */
-class TransferFun3DComponent : public Component
+class TransferFun3DComponent : public Component, public AnalysisWorker::Task
 {
 public:
-    TransferFun3DComponent(AudioProcessorValueTreeState& vts)
+    TransferFun3DComponent(AudioProcessorValueTreeState& vts, FilterModelStore& modelStore)
         : m_maxValueZ(50), m_minValueZ(-50), m_valueStepZ(20),
-        m_vts(vts), m_dirName("Resources"), m_fileName("TransferFun3DShape.txt"),
-        m_numberOfSamples(150), m_appClass(-50,50, m_valuesToPlot)
+        m_vts(vts), m_modelStore(modelStore), m_modelVersion(0), m_dirName("Resources"), m_fileName("TransferFun3DShape.txt"),
+        m_numberOfSamples(512), m_coarseNumberOfSamples(48), m_appClass(-50,50, m_valuesToPlot, m_rootDataToPlot)
     {
         // In your constructor, you should add any child components, and
         // initialise any special settings that your component needs.
@@ -52,8 +56,17 @@ public:
         m_maxImag = 1.5; // std::min(paramPoleImag.maxValue, paramZeroImag.maxValue);
         m_minImag = -1.5; // std::max(paramPoleImag.minValue, paramZeroImag.minValue);
 
+        prepareLevel(m_coarseLevel, jmin(m_coarseNumberOfSamples, m_numberOfSamples));
+        prepareLevel(m_fineLevel, m_numberOfSamples);
+        m_rootUpdates.reserve(2*MAX_POLE_INSTANCES);
+
         m_appClass.updateData = [this]() {updateData();};
         m_appClass.logoPressed = [this]() {if(logoPressed!=nullptr) logoPressed();};
+        // first surface synchronous (full resolution), all updates come from the analysis worker
+        m_hasNewData = false;
+        auto model = m_modelStore.getModel();
+        m_modelVersion = model->version;
+        computeLevel(*model, m_fineLevel, nullptr);
         m_appClass.updateData();
 
         addAndMakeVisible(m_appClass);
@@ -83,19 +96,61 @@ public:
         m_appClass.setBounds(getLocalBounds());
     }
 
-    void setSomethingChanged()
+    // the GL view only renders on request, hidden (e.g. about box) it stops
+    void visibilityChanged() override
+    {
+        m_appClass.requestFrame();
+    }
+
+    /**
+     * analysis worker thread: a change is answered with the coarse grid, so
+     * the latency during a drag does not depend on the resolution. The full
+     * resolution follows in refine() once the changes stop.
+     */
+    void compute(const FilterModel& model) override
     {
-        m_appClass.setSomethingChanged();
+        if (model.version == m_modelVersion)
+            return;
+
+        m_modelVersion = model.version;
+        bool isCoarse = m_coarseLevel.size < m_fineLevel.size;
+        computeLevel(model, isCoarse ? m_coarseLevel : m_fineLevel, nullptr);
+        m_needsRefinement = isCoarse;
     }
 
+    bool needsRefinement() const override { return m_needsRefinement; };
+
+    void refine(const FilterModel& model, const std::function<bool()>& shouldCancel) override
+    {
+        // a new change restarts with the coarse grid, a cancelled pass is simply dropped
+        if (computeLevel(model, m_fineLevel, &shouldCancel))
+        {
+            m_modelVersion = model.version;
+            m_needsRefinement = false;
+        }
+    }
+
+    // message thread, the shape is rebuilt by the render thread
+    void publish() override
+    {
+        if (m_hasNewData)
+            m_appClass.setSomethingChanged();
+    }
+
+    // render thread (called by OpenGLAppClass before the shape is rebuilt)
     void updateData()
     {
-        updateDataFromPoleZero(m_valuesToPlot);
-        normalizeValues(m_valuesToPlot, m_valuesToPlot);
-        // update values from OpenGLAppCLass
-        m_appClass.m_pointsMatrix = m_valuesToPlot;
+        const ScopedLock lock(m_resultLock);
+        if (!m_hasNewData)
+            return;
+
+        // m_valuesToPlot is the points matrix of m_appClass
+        if (m_hasNewHeights)
+            m_valuesToPlot.swap(m_readyValues);
+        m_hasNewHeights = false;
+        m_rootDataToPlot = m_readyRootData;
+        m_hasNewData = false;
         // writeDataToFile(m_valuesToPlot);
-        
     }
 
     std::function<void()> logoPressed;
@@ -105,14 +160,27 @@ private:
     OpenGLAppClass m_appClass;
 
     AudioProcessorValueTreeState& m_vts;
+    FilterModelStore& m_modelStore;
+    // written by the analysis worker
+    std::atomic<uint32> m_modelVersion;
 
-    PNParameter m_PNparam;
-    int m_numOfPole = m_PNparam.maxNrOfPole;
-    int m_numOfZero = m_PNparam.maxNrOfZero;
-
+    // full resolution at rest, coarse resolution directly after a change
     int m_numberOfSamples;
-
-    std::vector<std::vector<float>> m_valuesToPlot;
+    int m_coarseNumberOfSamples;
+
+    // normalised heights (0...1 for m_minValueZ...m_maxValueZ)
+    SurfaceGrid m_valuesToPlot;
+    // double buffer between analysis worker and render thread
+    SurfaceGrid m_workValues;
+    SurfaceGrid m_readyValues;
+    // poles and zeros for the shader evaluation (same double buffer)
+    SurfaceRootData m_readyRootData;
+    SurfaceRootData m_rootDataToPlot;
+    CriticalSection m_resultLock;
+    std::atomic<bool> m_hasNewData;
+    bool m_hasNewHeights = false;
+    // worker thread only
+    bool m_needsRefinement = false;
 
     float m_minValueZ;
     float m_maxValueZ;
@@ -123,103 +191,306 @@ private:
     float m_minReal;
     float m_maxReal;
 
-    std::vector<std::complex<float>> m_poles;
-    std::vector<std::complex<float>> m_zeros;
-
     std::string m_dirName;
     std::string m_fileName;
 
-    void updateDataFromPoleZero(std::vector<std::vector<float>>& h)
+    /**
+     * |H(z)| in dB is a sum of one log-magnitude grid per root (pair):
+     * zeros add, poles subtract, the gain is a constant offset. Each grid is
+     * cached with the root it was computed for. If a root moves only its
+     * grid is recomputed and the running sum is corrected by the difference,
+     * so dragging one pole or zero costs O(grid) instead of O(grid*(P+Z)).
+     */
+    struct RootGrid
     {
-        float b0 = *(m_vts.getRawParameterValue(paramb0.ID));
-        b0 = pow(10, (b0/20));       // from dB to linear
-        if (b0 == 0)
-        {
-            h.resize(m_numberOfSamples);
+        bool valid = false;
+        bool on = false;
+        bool conj = false;
+        std::complex<float> root;
+        SurfaceGrid values;
 
-            for (auto kk = 0; kk < m_numberOfSamples; ++kk)
+        bool isSame(bool isOn, bool isConj, std::complex<float> r) const
+        {
+            if (!valid || isOn != on)
+                return false;
+            // the grid of an inactive root is empty, its position does not matter
+            return !on || (isConj == conj && r == root);
+        }
+    };
+    struct RootUpdate
+    {
+        RootGrid* grid;
+        bool wasOn;
+        bool on;
+        bool conj;
+        std::complex<float> root;
+        // +1 zero, -1 pole
+        float sign;
+    };
+    // cached grids of one resolution
+    struct SurfaceLevel
+    {
+        int size = 0;
+        RootGrid poleGrids[MAX_POLE_INSTANCES];
+        RootGrid zeroGrids[MAX_POLE_INSTANCES];
+        // sum over all zero grids minus all pole grids (without gain)
+        SurfaceGrid sum;
+        // z-plane position of every sample
+        SurfaceGrid posReal;
+        SurfaceGrid posImag;
+        int incrementalUpdates = 0;
+    };
+    SurfaceLevel m_coarseLevel;
+    SurfaceLevel m_fineLevel;
+    // changed roots of the current pass, at most every pole and zero (reserved once)
+    std::vector<RootUpdate> m_rootUpdates;
+    SurfaceRowPool m_rowPool;
+    // full re-summation to remove accumulated rounding errors
+    const int m_maxIncrementalUpdates = 256;
+    // lower limit of a single factor (the log of a root exactly on a grid point)
+    const float m_minFactor_dB = -200.f;
+
+    // sample positions: uniform grid, denser around the unit circle (same warp as the mesh)
+    void prepareLevel(SurfaceLevel& level, int size)
+    {
+        level.size = size;
+        level.posReal.setSize(size, size);
+        level.posImag.setSize(size, size);
+        float step = 1.f / (size - 1);
+        float circleRadius = 1.f / jmax(m_maxReal - m_minReal, m_maxImag - m_minImag);
+        for (auto kk = 0; kk < size; ++kk)
+        {
+            for (auto jj = 0; jj < size; ++jj)
             {
-                h[kk].resize(m_numberOfSamples);
-                for (auto jj = 0; jj < m_numberOfSamples; ++jj)
-                    h[kk][jj] = 0;
+                float x = jj * step;
+                float y = kk * step;
+                warpGridPosition(x, y, circleRadius);
+                level.posReal(kk, jj) = x * (m_maxReal - m_minReal) + m_minReal;
+                level.posImag(kk, jj) = y * (m_maxImag - m_minImag) + m_minImag;
             }
         }
-        else
+        invalidateLevel(level);
+    }
+
+    static void invalidateLevel(SurfaceLevel& level)
+    {
+        level.sum.setSize(level.size, level.size);
+        level.incrementalUpdates = 0;
+        for (auto kk = 0; kk < MAX_POLE_INSTANCES; ++kk)
         {
-            updatePoleAndZero();
+            level.poleGrids[kk].valid = false;
+            level.zeroGrids[kk].valid = false;
+        }
+    }
 
-            float realStep = (m_maxReal - m_minReal) / (m_numberOfSamples - 1);
-            float imagStep = (m_maxImag - m_minImag) / (m_numberOfSamples - 1);
+    // evaluates the level and hands it over, returns false if cancelled
+    bool computeLevel(const FilterModel& model, SurfaceLevel& level, const std::function<bool()>* shouldCancel)
+    {
+        SurfaceRootData rootData;
+        rootData.setFromModel(model);
+        rootData.planeMin[0] = m_minReal;
+        rootData.planeMin[1] = m_minImag;
+        rootData.planeSize[0] = m_maxReal - m_minReal;
+        rootData.planeSize[1] = m_maxImag - m_minImag;
+        rootData.gridSize = level.size;
+
+        // the shader evaluates the surface itself, only the roots are needed
+        bool computeHeights = !m_appClass.isShaderSurfaceAvailable();
+        if (computeHeights && !updateDataFromModel(model, level, m_workValues, shouldCancel))
+            return false;
+
+        const ScopedLock lock(m_resultLock);
+        if (computeHeights)
+        {
+            m_readyValues.swap(m_workValues);
+            m_hasNewHeights = true;
+        }
+        m_readyRootData = rootData;
+        m_hasNewData = true;
+        return true;
+    }
 
-            h.resize(m_numberOfSamples);
+    void addRootUpdate(std::vector<RootUpdate>& updates, RootGrid& grid, int size,
+        bool isOn, bool isConj, std::complex<float> r, float sign)
+    {
+        if (grid.isSame(isOn, isConj, r))
+            return;
 
-            for (auto kk = 0; kk < m_numberOfSamples; ++kk)
-            {
-                h[kk].resize(m_numberOfSamples);
+        if (grid.values.getNumRows() != size)
+            grid.values.setSize(size, size);
 
-                for (auto jj = 0; jj < m_numberOfSamples; ++jj)
-                {
-                    std::complex<float> z(jj * realStep + m_minReal, kk * imagStep + m_minImag);
+        updates.push_back({ &grid, grid.valid && grid.on, isOn, isConj, r, sign });
+    }
 
-                    std::complex<float> h_z;
-                    h_z = b0;
-                    for (auto ll = 0U; ll < m_zeros.size(); ++ll)
-                        h_z *= (z - m_zeros[ll]);
-                    for (auto ll = 0U; ll < m_poles.size(); ++ll)
-                        h_z /= (z - m_poles[ll]);
+    // recomputes the changed root grids and corrects the sum, one row at a time
+    void updateRootRow(SurfaceLevel& level, const RootUpdate& update, int row)
+    {
+        const int nrofColumns = level.size;
+        float* sum = level.sum.getRow(row);
+        float* values = update.grid->values.getRow(row);
+        const float sign = update.sign;
+        if (!update.on)
+        {
+            // an invalidated level queues roots that stay off, their grids are not part of the sum
+            if (!update.wasOn)
+                return;
 
-                    h[kk][jj] = 20 * log10(std::abs(h_z));
-                }
-            }
+            // switched off, remove the old contribution
+            for (auto jj = 0; jj < nrofColumns; ++jj)
+                sum[jj] -= sign*values[jj];
+            return;
         }
-    }
 
-    void updatePoleAndZero()
-    {
-        m_poles.clear();
-        m_zeros.clear();
+        const float* posReal = level.posReal.getRow(row);
+        const float* posImag = level.posImag.getRow(row);
+        const float oldScale = update.wasOn ? 1.f : 0.f;
+        const bool isConj = update.conj;
+        const float minPower = std::pow(10.f, m_minFactor_dB/10.f);
+        const float rootReal = update.root.real();
+        const float rootImag = update.root.imag();
 
-        for (auto kk = 0; kk < m_numOfPole; ++kk)
+        // branch free, so the compiler vectorises the row
+        for (auto jj = 0; jj < nrofColumns; ++jj)
         {
-            if (m_vts.getParameter(paramPoleBool.ID[kk])->getValue())
-            {
-                float real = *(m_vts.getRawParameterValue(paramPoleReal.ID[kk]));
-                float imag = *(m_vts.getRawParameterValue(paramPoleImag.ID[kk]));
-                m_poles.push_back(std::complex<float>(real, imag));
+            float re = posReal[jj] - rootReal;
+            float re2 = re*re;
+            float dimag = posImag[jj] - rootImag;
+            float dimag2 = dimag*dimag;
+            float dimagConj = posImag[jj] + rootImag;
+            float dimagConj2 = dimagConj*dimagConj;
+            // |z-r|^2 (|z-r*|^2), one log for the pair
+            // (select, not 1 + c*(x-1), which loses x close to the conjugated root)
+            float power = (re2 + dimag2)*(isConj ? re2 + dimagConj2 : 1.f);
+            float newValue = fastPowerTodB(power < minPower ? minPower : power);
+            sum[jj] += sign*(newValue - oldScale*values[jj]);
+            values[jj] = newValue;
+        }
+    }
 
-                if (m_vts.getParameter(paramPoleConjugated.ID[kk])->getValue())
-                    m_poles.push_back(std::complex<float>(real, -imag));
-            }
+    // the flags of the updated grids are set after the pass, so the new ones are used here
+    static void resumRow(SurfaceLevel& level, int row, const std::vector<RootUpdate>& updates)
+    {
+        float* sum = level.sum.getRow(row);
+        FloatVectorOperations::clear(sum, level.size);
+        for (auto kk = 0; kk < MAX_POLE_INSTANCES; ++kk)
+        {
+            if (isRootOn(level.zeroGrids[kk], updates))
+                FloatVectorOperations::add(sum, level.zeroGrids[kk].values.getRow(row), level.size);
+            if (isRootOn(level.poleGrids[kk], updates))
+                FloatVectorOperations::subtract(sum, level.poleGrids[kk].values.getRow(row), level.size);
         }
-        for (auto kk = 0; kk < m_numOfPole; ++kk)
+    }
+
+    // debug check: the running sum of a row equals the sum over the active grids
+    static bool isSumConsistent(const SurfaceLevel& level, int row)
+    {
+        const float* sum = level.sum.getRow(row);
+        for (auto jj = 0; jj < level.size; ++jj)
         {
-            if (m_vts.getParameter(paramZeroBool.ID[kk])->getValue())
+            float expected = 0.f;
+            for (auto kk = 0; kk < MAX_POLE_INSTANCES; ++kk)
             {
-                float real = *(m_vts.getRawParameterValue(paramZeroReal.ID[kk]));
-                float imag = *(m_vts.getRawParameterValue(paramZeroImag.ID[kk]));
-                m_zeros.push_back(std::complex<float>(real, imag));
-
-                if (m_vts.getParameter(paramZeroConjugated.ID[kk])->getValue())
-                    m_zeros.push_back(std::complex<float>(real, -imag));
+                if (level.zeroGrids[kk].valid && level.zeroGrids[kk].on)
+                    expected += level.zeroGrids[kk].values.getRow(row)[jj];
+                if (level.poleGrids[kk].valid && level.poleGrids[kk].on)
+                    expected -= level.poleGrids[kk].values.getRow(row)[jj];
             }
+            if (std::abs(sum[jj] - expected) > 1e-2f*(1.f + std::abs(expected)))
+                return false;
         }
+        return true;
     }
 
-    void normalizeValues(std::vector<std::vector<float>>& in,
-        std::vector<std::vector<float>>& out)
+    static bool isRootOn(const RootGrid& grid, const std::vector<RootUpdate>& updates)
     {
-        if (in.size() != out.size())
-            return;
-        float valueIn;
-        for (auto kk = 0U; kk < m_numberOfSamples; ++kk)
-            for (auto jj = 0U; jj < m_numberOfSamples; ++jj)
+        for (auto& update : updates)
+            if (update.grid == &grid)
+                return update.on;
+
+        return grid.valid && grid.on;
+    }
+
+    /**
+     * one pass over all rows (spread over the row pool): update the changed
+     * root grids, correct the sum and write the normalised heights.
+     * If shouldCancel returns true the pass stops, the level is then
+     * partially updated and has to be rebuilt completely next time.
+     */
+    bool updateDataFromModel(const FilterModel& model, SurfaceLevel& level, SurfaceGrid& h,
+        const std::function<bool()>* shouldCancel)
+    {
+        const int size = level.size;
+        if (h.getNumRows() != size)
+            h.setSize(size, size);
+
+        // no allocation per model change
+        std::vector<RootUpdate>& updates = m_rootUpdates;
+        updates.clear();
+        for (auto kk = 0; kk < MAX_POLE_INSTANCES; ++kk)
+        {
+            const FilterModel::Section& section = model.sections[kk];
+            addRootUpdate(updates, level.zeroGrids[kk], size, section.zeroOn, section.zeroConj, section.zero, 1.f);
+            addRootUpdate(updates, level.poleGrids[kk], size, section.poleOn, section.poleConj, section.pole, -1.f);
+        }
+
+        bool resum = false;
+        if (!updates.empty() && ++level.incrementalUpdates > m_maxIncrementalUpdates)
+        {
+            resum = true;
+            level.incrementalUpdates = 0;
+        }
+
+        float b0 = model.gainLin;
+        // H = 0 is shown as the 0 dB plane
+        const float gainScale = b0 == 0 ? 0.f : 1.f;
+        const float gain_dB = b0 == 0 ? 0.f : 20 * log10(std::abs(b0));
+        const float normScale = 1.f/(m_maxValueZ - m_minValueZ);
+        const float normOffset = (gain_dB - m_minValueZ)*normScale;
+
+        std::atomic<bool> cancelled(false);
+        m_rowPool.run(size, [&](int firstRow, int endRow)
+        {
+            for (auto row = firstRow; row < endRow; ++row)
             {
-                valueIn = in[kk][jj];
-                out[kk][jj] = (valueIn - m_minValueZ) / (m_maxValueZ - m_minValueZ);
+                if (shouldCancel != nullptr && (cancelled || (*shouldCancel)()))
+                {
+                    cancelled = true;
+                    return;
+                }
+
+                for (auto& update : updates)
+                    updateRootRow(level, update, row);
+
+                if (resum)
+                    resumRow(level, row, updates);
+
+                // fused normalisation
+                const float* sum = level.sum.getRow(row);
+                float* out = h.getRow(row);
+                for (auto jj = 0; jj < size; ++jj)
+                    out[jj] = gainScale*sum[jj]*normScale + normOffset;
             }
+        });
+
+        if (cancelled)
+        {
+            invalidateLevel(level);
+            return false;
+        }
+
+        for (auto& update : updates)
+        {
+            update.grid->valid = true;
+            update.grid->on = update.on;
+            update.grid->conj = update.conj;
+            update.grid->root = update.root;
+        }
+        // a rebuild after a cancelled pass has to give the same surface as a full rebuild
+        jassert(isSumConsistent(level, 0) && isSumConsistent(level, size/2));
+        return true;
     }
 
-    void writeDataToFile(std::vector<std::vector<float>>& in)
+    void writeDataToFile(const SurfaceGrid& in)
     {
 
         auto dir = juce::File::getCurrentWorkingDirectory();
@@ -230,8 +501,8 @@ private:
             dir.getChildFile("Resources").getChildFile("TransferFun3DShape.txt").deleteFile();
         FileOutputStream outputFile(dir.getChildFile("Resources").getChildFile("TransferFun3DShape.txt"));
 
-        float realStep = 1 / static_cast<float>(in.size() - 1);
-        float imagStep = 1 / static_cast<float>(in[0].size() - 1);
+        float realStep = 1 / static_cast<float>(in.getNumColumns() - 1);
+        float imagStep = 1 / static_cast<float>(in.getNumRows() - 1);
         float alpha = 1.0;
 
         Colour poleCol = PoleColour; //
@@ -242,32 +513,32 @@ private:
         gradient.addColour(0.5, NeutralColour);
         gradient.addColour(0.3, ZeroLightColour);
         int counter = 1;
-        for (auto kk = 0U; kk < in.size(); ++kk) // imag
+        for (auto kk = 0; kk < in.getNumRows(); ++kk) // imag
         {
-            for (auto jj = 0U; jj < in[kk].size(); ++jj) // real
+            for (auto jj = 0; jj < in.getNumColumns(); ++jj) // real
             {
                 outputFile << "v " << jj * realStep << " " << kk * imagStep
-                    << " " << in[kk][jj] << "\n";
+                    << " " << in(kk, jj) << "\n";
 
-                Colour usedColour = gradient.getColourAtPosition(in[kk][jj]);
+                Colour usedColour = gradient.getColourAtPosition(in(kk, jj));
                 float redVal = usedColour.getFloatRed();
                 float greenVal = usedColour.getFloatGreen();
                 float blueVal = usedColour.getFloatBlue();
                 /*
-                float redVal = (1 - in[kk][jj]) * zeroCol.getFloatRed() + in[kk][jj] * poleCol.getFloatRed();
-                float greenVal = (1 - in[kk][jj]) * zeroCol.getFloatGreen() + in[kk][jj] * poleCol.getFloatGreen();
-                float blueVal = (1 - in[kk][jj]) * zeroCol.getFloatBlue() + in[kk][jj] * poleCol.getFloatBlue();
+                float redVal = (1 - in(kk, jj)) * zeroCol.getFloatRed() + in(kk, jj) * poleCol.getFloatRed();
+                float greenVal = (1 - in(kk, jj)) * zeroCol.getFloatGreen() + in(kk, jj) * poleCol.getFloatGreen();
+                float blueVal = (1 - in(kk, jj)) * zeroCol.getFloatBlue() + in(kk, jj) * poleCol.getFloatBlue();
                 // */
 
                 outputFile << "vt " << redVal << " " << greenVal
                     << " " << blueVal << " " << alpha << "\n";
 
-                int index1 = kk * in[kk].size() + jj + 1;
-                int index2 = index1 + in.size();
+                int index1 = kk * in.getNumColumns() + jj + 1;
+                int index2 = index1 + in.getNumRows();
                 int index3 = index1 + 1;
                 int index4 = index2 + 1;
 
-                if (!(kk == in.size() - 1 || jj == in[kk].size() - 1))
+                if (!(kk == in.getNumRows() - 1 || jj == in.getNumColumns() - 1))
                 {
                     outputFile << "f " << index1 << "/" << index1 << "/" << index1;
                     outputFile << " " << index2 << "/" << index2 << "/" << index2;
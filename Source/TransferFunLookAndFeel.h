@@ -44,6 +44,10 @@ const auto AxisTextColour(Colours::black);
 const auto BorderColour(JadeGray.darker(0.2));
 const auto PlotColour(JadeRed);
 const auto PlotBackgroundColour(BackgroundColour);
+const auto SpectrumInputColour(JadeGray.withAlpha(0.3f));
+const auto SpectrumOutputColour(JadeTeal.darker(0.5));
+const auto SpectrumTransferColour(Colours::darkorange);
+const auto SpectrumCoherenceColour(Colours::steelblue.withAlpha(0.2f));
 
 const auto PoleColour(Colours::red);
 const auto PoleLightColour(Colours::orange);